@@ -14,7 +14,7 @@ set INCDIR=%~dp0..\include
 where g++ >nul 2>nul
 if %ERRORLEVEL%==0 (
   echo Building with g++ %TRACEFLAG%
-  g++ -std=c++20 -O2 -Wall -Wextra -pedantic -I"%INCDIR%" %TRACEFLAG% "%SRCDIR%\main.cpp" -o %TARGET% || goto :err
+  g++ -std=c++20 -O2 -Wall -Wextra -pedantic -pthread -I"%INCDIR%" %TRACEFLAG% "%SRCDIR%\main.cpp" -o %TARGET% || goto :err
   echo Running %TARGET%
   .\%TARGET%
   goto :eof
@@ -23,7 +23,7 @@ if %ERRORLEVEL%==0 (
 where clang++ >nul 2>nul
 if %ERRORLEVEL%==0 (
   echo Building with clang++ %TRACEFLAG%
-  clang++ -std=c++20 -O2 -Wall -Wextra -pedantic -I"%INCDIR%" %TRACEFLAG% "%SRCDIR%\main.cpp" -o %TARGET% || goto :err
+  clang++ -std=c++20 -O2 -Wall -Wextra -pedantic -pthread -I"%INCDIR%" %TRACEFLAG% "%SRCDIR%\main.cpp" -o %TARGET% || goto :err
   echo Running %TARGET%
   .\%TARGET%
   goto :eof
@@ -19,7 +19,7 @@ function Have($cmd) {
 
 if (Have "g++") {
   Write-Host "Building with g++ $traceFlag"
-  & g++ -std=c++20 -O2 -Wall -Wextra -pedantic -I"$incDir" $traceFlag "$srcDir\main.cpp" -o $target
+  & g++ -std=c++20 -O2 -Wall -Wextra -pedantic -pthread -I"$incDir" $traceFlag "$srcDir\main.cpp" -o $target
   if ($LASTEXITCODE -ne 0) { exit $LASTEXITCODE }
   Write-Host "Running $target"
   & .\$target
@@ -28,7 +28,7 @@ if (Have "g++") {
 
 if (Have "clang++") {
   Write-Host "Building with clang++ $traceFlag"
-  & clang++ -std=c++20 -O2 -Wall -Wextra -pedantic -I"$incDir" $traceFlag "$srcDir\main.cpp" -o $target
+  & clang++ -std=c++20 -O2 -Wall -Wextra -pedantic -pthread -I"$incDir" $traceFlag "$srcDir\main.cpp" -o $target
   if ($LASTEXITCODE -ne 0) { exit $LASTEXITCODE }
   Write-Host "Running $target"
   & .\$target
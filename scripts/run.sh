@@ -15,7 +15,7 @@ INC_DIR="$(dirname "$0")/../include"
 # Try clang++ first (default on macOS)
 if command -v clang++ &> /dev/null; then
     echo "Building with clang++ $TRACE_FLAG"
-    clang++ -std=c++20 -O2 -Wall -Wextra -pedantic -I"$INC_DIR" $TRACE_FLAG "$SRC_DIR/main.cpp" -o "$TARGET"
+    clang++ -std=c++20 -O2 -Wall -Wextra -pedantic -pthread -I"$INC_DIR" $TRACE_FLAG "$SRC_DIR/main.cpp" -o "$TARGET"
     if [[ $? -ne 0 ]]; then
         echo "Build failed."
         exit 1
@@ -28,7 +28,7 @@ fi
 # Fall back to g++
 if command -v g++ &> /dev/null; then
     echo "Building with g++ $TRACE_FLAG"
-    g++ -std=c++20 -O2 -Wall -Wextra -pedantic -I"$INC_DIR" $TRACE_FLAG "$SRC_DIR/main.cpp" -o "$TARGET"
+    g++ -std=c++20 -O2 -Wall -Wextra -pedantic -pthread -I"$INC_DIR" $TRACE_FLAG "$SRC_DIR/main.cpp" -o "$TARGET"
     if [[ $? -ne 0 ]]; then
         echo "Build failed."
         exit 1
@@ -1,13 +1,48 @@
+/*
+ * Only the std::execution policy TAGS are used; the parallel work is our own
+ * std::thread code. Keep libstdc++ from switching to its TBB backend, which
+ * would need -ltbb at link time in unoptimized builds. Standard libraries
+ * without <execution> support (libc++ without -fexperimental-library) still
+ * build everything else: the policy overloads sit behind __cpp_lib_execution.
+ */
+#ifndef _GLIBCXX_USE_TBB_PAR_BACKEND
+#  define _GLIBCXX_USE_TBB_PAR_BACKEND 0
+#endif
+
 #include <iostream>
 #include <cassert>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <set>
+#include <type_traits>
+#include <version>
+#if defined(__cpp_lib_execution)
+#include <execution>
+#endif
 
 #ifdef TRACE
 #include "../include/trace_ui.hpp"
 #endif
 
+/* Hint the CPU to start loading an address we will need soon (no-op elsewhere). */
+#if defined(__GNUC__) || defined(__clang__)
+#  define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#  define PREFETCH(addr) ((void)(addr))
+#endif
+
 /*
  * =============================================================================
  * Data Structures
@@ -173,6 +208,7 @@ Node* ListRemoveAfter(List* list, Node* prev) {
 /**
  * FindInsertionSpot - Finds the node that should come right BEFORE a new value
  * in the sorted part of the list. Returns nullptr if the value should be the new head.
+ * Nodes with an equal value stay in front of the new one, which keeps the sort stable.
  */
 Node* FindInsertionSpot(const List* list, int value, Node* boundary) {
     Node* prev = nullptr;
@@ -181,16 +217,17 @@ Node* FindInsertionSpot(const List* list, int value, Node* boundary) {
     /*
      * Scan the list. curr moves forward, prev follows one step behind.
      * Stop when curr hits the boundary or finds a value bigger than our new one.
+     * Equal values are stepped over (<=), so the new value lands AFTER them.
      *
      * EXAMPLE: Find spot for 22 in [ 11 -> 39 -> 45 ]. Boundary is nullptr (end of list).
      *
-     * 1. curr=11. 11 < 22. prev becomes 11, curr becomes 39.
-     * 2. curr=39. 39 is NOT < 22. Loop stops.
+     * 1. curr=11. 11 <= 22. prev becomes 11, curr becomes 39.
+     * 2. curr=39. 39 is NOT <= 22. Loop stops.
      *
      * Function returns prev, which is the node containing 11.
      * This tells us: "Insert 22 AFTER the node with 11".
      */
-    while (curr != boundary && curr->data < value) {
+    while (curr != boundary && curr->data <= value) {
         prev = curr;
         curr = curr->next;
     }
@@ -304,35 +341,3912 @@ void ListInsertionSort(List* list) {
 
 /*
  * =============================================================================
- * Test Functions
+ * Deduplicating Sort
  * =============================================================================
  */
 
-/** Adds a new node to the end of the list. */
-void PushBack(List* list, int data) {
-    Node* n = new Node(data);
-    if (!list->head) {
-        list->head = n;
+/**
+ * ListTail - Returns the last node of the list, or nullptr if it is empty.
+ */
+Node* ListTail(const List* list) {
+    Node* curr = list->head;
+    while (curr && curr->next) curr = curr->next;
+    return curr;
+}
+
+/**
+ * ListAppend - Puts a node at the end of the list. The caller keeps `tail`
+ * pointing at the last node (nullptr while the list is empty), so each append is O(1).
+ */
+void ListAppend(List* list, Node*& tail, Node* node) {
+    node->next = nullptr;
+    if (tail == nullptr) {
+        list->head = node;
+    } else {
+        tail->next = node;
+    }
+    tail = node;
+}
+
+/**
+ * DiscardNode - Hands over a node that was already unlinked from its list.
+ * If the caller gave us a `removed` list, the node is appended to it, so the
+ * dropped nodes keep their original order. Otherwise the node is deleted.
+ * `removedTail` remembers the end of `removed` so each append is O(1).
+ */
+static void DiscardNode(List* removed, Node*& removedTail, Node* node) {
+    if (removed == nullptr) {
+        delete node;
         return;
     }
-    Node* curr = list->head;
-    while (curr->next) curr = curr->next;
-    curr->next = n;
+    ListAppend(removed, removedTail, node);
 }
 
-/** Prints the list to the console. */
-void PrintList(const List* list) {
+/**
+ * ListInsertionSortUnique - Sorts the list and drops repeated keys in the same pass.
+ *
+ * Only the FIRST node of every key survives, so the result is exactly what
+ * ListInsertionSort followed by a "unique" pass would give, without the second
+ * walk over the list. Dropped nodes are appended to `removed` in the order they
+ * were found, or deleted when `removed` is nullptr. Returns how many were dropped.
+ *
+ * Time: O(n^2), Space: O(1), Stable: Yes
+ */
+size_t ListInsertionSortUnique(List* list, List* removed = nullptr) {
+    if (!list || !list->head) {
+        return 0;
+    }
+
+    Node* removedTail = removed ? ListTail(removed) : nullptr;
+    size_t dropped = 0;
+
+    /* Same roles as ListInsertionSort: head..prev is sorted AND duplicate-free. */
+    Node* prev = list->head;
+    Node* curr = prev->next;
+
+    while (curr != nullptr) {
+        Node* next = curr->next;
+        Node* spot = FindInsertionSpot(list, curr->data, /*boundary=*/curr);
+
+        /*
+         * FindInsertionSpot stops on the last node that is NOT bigger than curr,
+         * so if the sorted part already holds curr's key, spot is that node:
+         *
+         *   [ 11 ] -> [ 22 ] -> [ 39 ] ... curr = [ 22 ]
+         *               ^
+         *              spot  (22 == 22, so curr is a duplicate)
+         */
+        if (spot != nullptr && spot->data == curr->data) {
+            /* --- CASE 0: duplicate. Unlink it and never put it back. --- */
+            ListRemoveAfter(list, prev);
+            DiscardNode(removed, removedTail, curr);
+            ++dropped;
+        } else if (spot == prev) {
+            /* --- CASE 1: already in place. --- */
+            prev = curr;
+        } else {
+            /* --- CASE 2: move curr to its spot. --- */
+            ListRemoveAfter(list, prev);
+            if (spot == nullptr) {
+                ListPrepend(list, curr);
+            } else {
+                ListInsertAfter(list, spot, curr);
+            }
+        }
+
+        curr = next;
+    }
+    return dropped;
+}
+
+/*
+ * =============================================================================
+ * Group-By Over Sorted Lists
+ * =============================================================================
+ */
+
+/**
+ * A KeyRun describes one run of equal keys in a sorted list.
+ *
+ * VISUAL:
+ *   [ 3 ] -> [ 3 ] -> [ 3 ] -> [ 7 ] -> [ 9 ] -> [ 9 ]
+ *   \______ run ______/       \ run /  \__ run __/
+ *     key=3, count=3         key=7     key=9, count=2
+ */
+struct KeyRun {
+    int key;
+    const Node* first;  /* first node of the run */
+    size_t count;
+    long long sum;      /* sum/min/max are over valueOf(node) */
+    long long min;
+    long long max;
+};
+
+/**
+ * ListAggregateRuns - Walks a SORTED list once and calls emit(run) for each run
+ * of equal keys, in key order. Nothing is copied out of the list.
+ * valueOf(node) picks the number that gets summed; returns the number of runs.
+ *
+ * Time: O(n), Space: O(1)
+ */
+template <class ValueOf, class Emit>
+size_t ListAggregateRuns(const List* list, ValueOf valueOf, Emit emit) {
+    size_t runs = 0;
     const Node* curr = list->head;
-    while (curr) {
-        std::cout << curr->data;
-        if (curr->next) std::cout << " -> ";
-        curr = curr->next;
+
+    while (curr != nullptr) {
+        /* curr is the first node of a new run. */
+        long long v = valueOf(curr);
+        KeyRun run{curr->data, curr, 1, v, v, v};
+
+        /* Swallow every following node with the same key. */
+        const Node* next = curr->next;
+        while (next != nullptr && next->data == run.key) {
+            v = valueOf(next);
+            ++run.count;
+            run.sum += v;
+            run.min = std::min(run.min, v);
+            run.max = std::max(run.max, v);
+            next = next->next;
+        }
+
+        emit(run);
+        ++runs;
+        curr = next;
     }
-    std::cout << '\n';
+    return runs;
+}
+
+/** ListAggregateRuns - Same, aggregating the keys themselves. */
+template <class Emit>
+size_t ListAggregateRuns(const List* list, Emit emit) {
+    return ListAggregateRuns(list,
+                             [](const Node* n) { return static_cast<long long>(n->data); },
+                             emit);
+}
+
+/**
+ * ListCollapseRuns - Collapses every run of a SORTED list into its first node.
+ * The other nodes of each run are unlinked and go to `removed` (in order) or are
+ * deleted. Returns how many nodes were dropped.
+ *
+ * Time: O(n), Space: O(1)
+ */
+size_t ListCollapseRuns(List* list, List* removed = nullptr) {
+    Node* removedTail = removed ? ListTail(removed) : nullptr;
+    size_t dropped = 0;
+    Node* keep = list->head;
+
+    while (keep != nullptr) {
+        /* Everything right after `keep` with the same key is a duplicate. */
+        while (keep->next != nullptr && keep->next->data == keep->data) {
+            DiscardNode(removed, removedTail, ListRemoveAfter(list, keep));
+            ++dropped;
+        }
+        keep = keep->next;
+    }
+    return dropped;
+}
+
+/*
+ * =============================================================================
+ * Bulk Removal and Partitioning
+ * =============================================================================
+ */
+
+/**
+ * ListRemoveIf - Unlinks every node for which pred(node) is true, in one pass.
+ * Removed nodes go to `removed` (in order) or are deleted, so a caller that
+ * keeps `removed` around can reuse them instead of allocating new ones.
+ * Returns how many nodes were removed.
+ *
+ * prev is the last node we KEPT, so the node after it is always curr:
+ *
+ *   [ 1 ] -> [ 4 ] -> [ 6 ] -> [ 7 ]      pred = "is even"
+ *     ^        ^
+ *    prev     curr   -> ListRemoveAfter(prev), prev stays on [ 1 ]
+ *
+ * Only the links around removed nodes are rewritten; long kept runs are just read.
+ *
+ * Time: O(n), Space: O(1)
+ */
+template <class Pred>
+size_t ListRemoveIf(List* list, Pred pred, List* removed = nullptr) {
+    Node* removedTail = removed ? ListTail(removed) : nullptr;
+    size_t count = 0;
+    Node* prev = nullptr;
+    Node* curr = list->head;
+
+    while (curr != nullptr) {
+        Node* next = curr->next;
+        if (pred(static_cast<const Node*>(curr))) {
+            DiscardNode(removed, removedTail, ListRemoveAfter(list, prev));
+            ++count;
+        } else {
+            prev = curr;
+        }
+        curr = next;
+    }
+    return count;
+}
+
+/**
+ * ListPartition - Stable split in one pass: nodes with pred(node) true stay in
+ * `list`, the others move to the end of `rest`. Both keep their relative order.
+ *
+ *   list: 1 -> 4 -> 6 -> 7          pred = "is odd"
+ *   =>    list: 1 -> 7    rest: 4 -> 6
+ *
+ * Returns how many nodes moved to `rest`.
+ *
+ * Time: O(n), Space: O(1)
+ */
+template <class Pred>
+size_t ListPartition(List* list, Pred pred, List* rest) {
+    assert(rest != nullptr && "ListPartition needs a list for the other side");
+    return ListRemoveIf(list, [&pred](const Node* n) { return !pred(n); }, rest);
+}
+
+/*
+ * =============================================================================
+ * Merge-Join
+ * =============================================================================
+ */
+
+/**
+ * ListMergeJoin - Equi-join of two SORTED lists. Calls emit(leftNode, rightNode)
+ * for every pair of nodes with equal keys and returns how many pairs it emitted.
+ *
+ * Two cursors walk forward together; whichever points at the smaller key moves.
+ * When the keys match, every node of the left run is paired with every node of
+ * the right run (a cross product), then both cursors jump past their runs:
+ *
+ *   left:  [ 1 ] -> [ 4 ] -> [ 4 ] -> [ 9 ]
+ *   right: [ 4 ] -> [ 4 ] -> [ 4 ] -> [ 7 ]
+ *                   => 2 x 3 = 6 pairs for key 4
+ *
+ * Time: O(n + m + pairs), Space: O(1)
+ */
+template <class Emit>
+size_t ListMergeJoin(const List* left, const List* right, Emit emit) {
+    const Node* a = left->head;
+    const Node* b = right->head;
+    size_t pairs = 0;
+
+    while (a != nullptr && b != nullptr) {
+        if (a->data < b->data) {
+            a = a->next;
+        } else if (b->data < a->data) {
+            b = b->next;
+        } else {
+            const int key = a->data;
+
+            /* Find where the right run ends, so it can be replayed for each left node. */
+            const Node* rightEnd = b;
+            while (rightEnd != nullptr && rightEnd->data == key) rightEnd = rightEnd->next;
+
+            for (; a != nullptr && a->data == key; a = a->next) {
+                for (const Node* r = b; r != rightEnd; r = r->next) {
+                    emit(a, r);
+                    ++pairs;
+                }
+            }
+            b = rightEnd;
+        }
+    }
+    return pairs;
+}
+
+/*
+ * =============================================================================
+ * Merging and Set Operations
+ * =============================================================================
+ */
+
+/**
+ * ListMerge - Merges the SORTED list `other` into the SORTED list `list`.
+ * Nodes are relinked, never copied; `other` is left empty.
+ * On equal keys the nodes of `list` come first, so the merge is stable.
+ *
+ *   list:  [ 1 ] -> [ 5 ] -> [ 8 ]
+ *   other: [ 2 ] -> [ 5 ]
+ *   =>     [ 1 ] -> [ 2 ] -> [ 5 ] -> [ 5' ] -> [ 8 ]
+ *
+ * Time: O(n + m), Space: O(1)
+ */
+void ListMerge(List* list, List* other) {
+    Node* a = list->head;
+    Node* b = other->head;
+    Node* tail = nullptr;
+    list->head = nullptr;
+    other->head = nullptr;
+
+    while (a != nullptr && b != nullptr) {
+        /* Take from `other` only when it is strictly smaller (stability). */
+        if (b->data < a->data) {
+            Node* next = b->next;
+            ListAppend(list, tail, b);
+            b = next;
+        } else {
+            Node* next = a->next;
+            ListAppend(list, tail, a);
+            a = next;
+        }
+    }
+
+    /* One side ran out; the rest of the other side is already in order. */
+    Node* rest = (a != nullptr) ? a : b;
+    if (tail == nullptr) {
+        list->head = rest;
+    } else {
+        tail->next = rest;
+    }
+}
+
+/** Which set operation ListSetOperation should compute. */
+enum class SetOp {
+    Union,                /* keys in either list */
+    Intersection,         /* keys in both lists */
+    Difference,           /* keys in `list` but not in `other` */
+    SymmetricDifference,  /* keys in exactly one of the lists */
+};
+
+/**
+ * ListSetOperation - Combines two SORTED lists into `list` by relinking nodes.
+ *
+ * The lists are walked one key at a time. For each key we count its run in
+ * both lists (ra, rb) and decide how many nodes of each run survive:
+ *
+ *   op                    set mode (multiset=false)   multiset mode
+ *   Union                 1                           max(ra, rb)
+ *   Intersection          1 if ra>0 and rb>0          min(ra, rb)
+ *   Difference            1 if ra>0 and rb==0         ra - rb (if positive)
+ *   SymmetricDifference   1 if only one side has it   |ra - rb|
+ *
+ * Survivors are taken from `list` first, then from `other` (like std::set_union).
+ * `other` is left empty. Nodes that do not survive go to `removed` (in order)
+ * or are deleted. Returns the number of nodes in the result.
+ *
+ * Time: O(n + m), Space: O(1)
+ */
+size_t ListSetOperation(List* list, List* other, SetOp op, bool multiset = false,
+                        List* removed = nullptr) {
+    Node* a = list->head;
+    Node* b = other->head;
+    Node* tail = nullptr;
+    Node* removedTail = removed ? ListTail(removed) : nullptr;
+    size_t kept = 0;
+    list->head = nullptr;
+    other->head = nullptr;
+
+    while (a != nullptr || b != nullptr) {
+        /* The smallest key still waiting in either list. */
+        const int key = (b == nullptr || (a != nullptr && a->data <= b->data)) ? a->data : b->data;
+
+        size_t ra = 0;
+        for (const Node* n = a; n != nullptr && n->data == key; n = n->next) ++ra;
+        size_t rb = 0;
+        for (const Node* n = b; n != nullptr && n->data == key; n = n->next) ++rb;
+
+        size_t keepA = 0;
+        size_t keepB = 0;
+        switch (op) {
+            case SetOp::Union:
+                keepA = multiset ? ra : std::min<size_t>(ra, 1);
+                keepB = multiset ? (rb > ra ? rb - ra : 0) : (ra == 0 ? std::min<size_t>(rb, 1) : 0);
+                break;
+            case SetOp::Intersection:
+                keepA = multiset ? std::min(ra, rb) : (ra > 0 && rb > 0 ? 1 : 0);
+                break;
+            case SetOp::Difference:
+                keepA = multiset ? (ra > rb ? ra - rb : 0) : (ra > 0 && rb == 0 ? 1 : 0);
+                break;
+            case SetOp::SymmetricDifference:
+                keepA = multiset ? (ra > rb ? ra - rb : 0) : (ra > 0 && rb == 0 ? 1 : 0);
+                keepB = multiset ? (rb > ra ? rb - ra : 0) : (rb > 0 && ra == 0 ? 1 : 0);
+                break;
+        }
+
+        /* Move the run of each list: the first keepX nodes survive, the rest are dropped. */
+        for (size_t i = 0; i < ra; ++i) {
+            Node* next = a->next;
+            if (i < keepA) {
+                ListAppend(list, tail, a);
+            } else {
+                DiscardNode(removed, removedTail, a);
+            }
+            a = next;
+        }
+        for (size_t i = 0; i < rb; ++i) {
+            Node* next = b->next;
+            if (i < keepB) {
+                ListAppend(list, tail, b);
+            } else {
+                DiscardNode(removed, removedTail, b);
+            }
+            b = next;
+        }
+        kept += keepA + keepB;
+    }
+    return kept;
+}
+
+/*
+ * =============================================================================
+ * Static Search Index (Eytzinger layout)
+ * =============================================================================
+ */
+
+/**
+ * A ListIndex is a read-only snapshot of a SORTED list for fast lookups.
+ *
+ * The keys are stored in Eytzinger (breadth-first) order: slot 1 is the root of
+ * an implicit binary search tree and slot k has its children at 2k and 2k+1.
+ * The top levels of the tree share a few cache lines, so a search touches far
+ * fewer lines than a binary search over a plain sorted array.
+ *
+ * VISUAL (sorted keys 10 20 30 40 50 60 70):
+ *
+ *               40            slot:  1    2    3    4    5    6    7
+ *             /    \          keys: [40] [20] [60] [10] [30] [50] [70]
+ *           20      60
+ *          /  \    /  \
+ *        10   30  50   70
+ *
+ * nodes[k] is the list node that keys[k] was copied from. The index does not
+ * follow later changes to the list; rebuild it after inserting or removing.
+ */
+struct ListIndex {
+    std::vector<int> keys;     /* keys[1..n] in Eytzinger order, keys[0] unused */
+    std::vector<Node*> nodes;  /* nodes[k] owns keys[k] */
+    size_t size() const { return keys.size() - 1; }
+};
+
+/** Fills the subtree rooted at slot k from the list in order (an in-order walk). */
+static void FillEytzinger(ListIndex* index, Node*& curr, size_t k) {
+    if (k > index->size()) {
+        return;
+    }
+    FillEytzinger(index, curr, 2 * k);      /* smaller keys first */
+    index->keys[k] = curr->data;
+    index->nodes[k] = curr;
+    curr = curr->next;
+    FillEytzinger(index, curr, 2 * k + 1);  /* then the larger keys */
+}
+
+/**
+ * ListIndexBuild - Snapshots a SORTED list into a ListIndex.
+ *
+ * Time: O(n), Space: O(n)
+ */
+ListIndex ListIndexBuild(const List* list) {
+    size_t n = 0;
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next) ++n;
+
+    ListIndex index;
+    index.keys.assign(n + 1, 0);
+    index.nodes.assign(n + 1, nullptr);
+    Node* curr = list->head;
+    FillEytzinger(&index, curr, 1);
+    return index;
+}
+
+/**
+ * EytzingerSearch - Descends the implicit tree without branching on the keys:
+ * each step goes to 2k (left) or 2k+1 (right) using the comparison result as a number.
+ * `Strict` picks lower_bound (key < value goes right) or upper_bound (key <= value).
+ * Returns the node of the first key that did NOT go right, or nullptr if none.
+ */
+template <bool Strict>
+static Node* EytzingerSearch(const ListIndex* index, int value) {
+    const size_t n = index->size();
+    const int* keys = index->keys.data();
+    size_t k = 1;
+    while (k <= n) {
+        /* Slot 16k is where we will be four levels down; start loading it now. */
+        PREFETCH(keys + (16 * k <= n ? 16 * k : 0));
+        k = 2 * k + (Strict ? keys[k] < value : keys[k] <= value);
+    }
+    /*
+     * The path ended below a leaf. Every trailing 1 bit of k is a step to the
+     * right; undoing them (and the last left step) gives the answer's slot.
+     */
+    k >>= std::countr_one(k) + 1;
+    return (k == 0) ? nullptr : index->nodes[k];
+}
+
+/**
+ * ListIndexLowerBound - First node whose key is >= value, or nullptr.
+ *
+ * Time: O(log n)
+ */
+Node* ListIndexLowerBound(const ListIndex* index, int value) {
+    return EytzingerSearch</*Strict=*/true>(index, value);
+}
+
+/**
+ * ListIndexUpperBound - First node whose key is > value, or nullptr.
+ *
+ * Time: O(log n)
+ */
+Node* ListIndexUpperBound(const ListIndex* index, int value) {
+    return EytzingerSearch</*Strict=*/false>(index, value);
 }
 
-/** Main function to run the test. */
-int main() {
+/**
+ * ListIndexEqualRange - The nodes with key == value, as [first, last):
+ * walk first->next until reaching last (nullptr means the end of the list).
+ * The range is empty when first == last.
+ *
+ * Time: O(log n)
+ */
+std::pair<Node*, Node*> ListIndexEqualRange(const ListIndex* index, int value) {
+    return {ListIndexLowerBound(index, value), ListIndexUpperBound(index, value)};
+}
+
+/*
+ * =============================================================================
+ * Batched Lookups (many keys, overlapping cache misses)
+ * =============================================================================
+ */
+
+/*
+ * One walk down a list waits for one cache miss per node: it cannot read
+ * curr->next before curr has arrived. A batch of lookups on DIFFERENT lists
+ * (hash buckets, shards, per-tenant lists) has no such chain between them, so
+ * we run up to `width` walks at once, round robin. Each walk takes one step,
+ * prefetches its next node and yields to the next walk. By the time its turn
+ * comes again the node is (ideally) in cache, and up to `width` misses are in
+ * flight instead of one:
+ *
+ *   slot 0: walk A  [a1]--->[a2]--->[a3]  done -> slot 0 picks up walk E
+ *   slot 1: walk B  [b1]--->[b2]--->...
+ *   slot 2: walk C  [c1]--->...
+ *           round:    1       2       3
+ *
+ * (This is AMAC: every walk is a tiny state machine, just a cursor, and a
+ * finished slot immediately starts the next lookup.)
+ */
+
+static constexpr size_t BATCH_DEFAULT_WIDTH = 16;  /* walks in flight at once */
+
+/** One lookup for ListLookupBatch: where to search, what for, and the answer. */
+struct ListLookup {
+    const List* list = nullptr;  /* a SORTED list */
+    int key = 0;
+    Node* result = nullptr;      /* first node with data >= key, nullptr if none */
+};
+
+/**
+ * ListLookupBatch - Fills in result for every lookup, running `width` walks
+ * interleaved. The answers are the same as one lower-bound walk per lookup.
+ *
+ * Time: O(total nodes walked), Space: O(width)
+ */
+void ListLookupBatch(std::vector<ListLookup>& lookups, size_t width = BATCH_DEFAULT_WIDTH) {
+    struct Slot {
+        size_t lookup;  /* which lookup this walk answers */
+        Node* curr;     /* where it is */
+    };
+    std::vector<Slot> slots;
+    size_t next = 0;
+    for (; next < lookups.size() && slots.size() < std::max<size_t>(width, 1); ++next) {
+        slots.push_back(Slot{next, lookups[next].list->head});
+        PREFETCH(slots.back().curr);
+    }
+
+    size_t active = slots.size();
+    while (active > 0) {
+        for (size_t i = 0; i < active;) {
+            Slot& slot = slots[i];
+            ListLookup& lookup = lookups[slot.lookup];
+
+            if (slot.curr != nullptr && slot.curr->data < lookup.key) {
+                /* One step, then let the other walks run while it loads. */
+                slot.curr = slot.curr->next;
+                PREFETCH(slot.curr);
+            } else {
+                lookup.result = slot.curr;
+                if (next == lookups.size()) {
+                    /* Nothing left to start: close the gap with the last active slot. */
+                    slot = slots[--active];
+                    continue;
+                }
+                slot = Slot{next, lookups[next].list->head};
+                PREFETCH(slot.curr);
+                ++next;
+            }
+            ++i;
+        }
+    }
+}
+
+/**
+ * ListLowerBoundBatch - For every key, the first node of a SORTED list with
+ * data >= key (nullptr if none), in the order of `keys`.
+ *
+ * Interleaving does not help here: every walk would start at the same head
+ * and wait on the same misses. Instead the keys are sorted (by position, so
+ * the list itself is never reordered) and ONE walk answers them all, since a
+ * bigger key's answer is never in front of a smaller key's.
+ *
+ *   keys  { 40, 5, 22 }  -> visit order 5, 22, 40
+ *   list  [ 3 ] -> [ 9 ] -> [ 22 ] -> [ 41 ]
+ *                   5        22        40
+ *
+ * Time: O(n + m log m) for m keys, Space: O(m)
+ */
+std::vector<Node*> ListLowerBoundBatch(const List* list, const std::vector<int>& keys) {
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::vector<Node*> results(keys.size());
+    Node* curr = list->head;
+    for (size_t i : order) {
+        while (curr != nullptr && curr->data < keys[i]) curr = curr->next;
+        results[i] = curr;
+    }
+    return results;
+}
+
+/*
+ * =============================================================================
+ * Indexable Skip List (order statistics over a sorted list)
+ * =============================================================================
+ */
+
+/*
+ * The sorted list itself is level 0. On top of it some nodes get a "tower" of
+ * express pointers that jump over many nodes at once. Every express pointer also
+ * stores its span: how many list nodes the jump moves forward. Adding up spans
+ * on the way down gives a node's position, which is what makes nth() and rank()
+ * O(log n) instead of a walk from list->head.
+ *
+ * VISUAL (spans in parentheses, a bare arrow spans 1):
+ *
+ *   level 2:  head -------------(4)-------------> [T] ----(2)----> null
+ *   level 1:  head ----(2)----> [T] -----(2)----> [T] ---> [T] ----(1)----> null
+ *   level 0:  head -> [ 3 ] -> [ 5 ] -> [ 8 ] -> [ 9 ] -> [12 ] -> [15 ]
+ *                              pos 2             pos 4    pos 5
+ */
+
+static constexpr int SKIP_MAX_LEVELS = 32;  /* express levels above the list */
+
+/** The express-lane part of one list node (or of the head sentinel). */
+struct SkipTower {
+    Node* node;                       /* node this tower stands on, nullptr for the head */
+    std::vector<SkipTower*> forward;  /* forward[L]: next tower on express level L */
+    std::vector<size_t> span;         /* span[L]: list nodes passed by following forward[L] */
+};
+
+/** A skip list laid over a sorted List. Towers belong to it; nodes belong to the list. */
+struct SkipList {
+    List* list = nullptr;
+    SkipTower* head = nullptr;  /* sentinel tower at position 0, full height */
+    int levels = 0;             /* express levels currently in use */
+    size_t size = 0;            /* nodes in the list */
+    uint32_t seed = 0x9E3779B9u;
+};
+
+/** Random tower height: each extra level is kept with probability 1/4 (xorshift32). */
+static int SkipRandomHeight(SkipList* sl) {
+    int height = 0;
+    for (;;) {
+        sl->seed ^= sl->seed << 13;
+        sl->seed ^= sl->seed >> 17;
+        sl->seed ^= sl->seed << 5;
+        if ((sl->seed & 3u) != 0 || height == SKIP_MAX_LEVELS) return height;
+        ++height;
+    }
+}
+
+static SkipTower* SkipNewTower(Node* node, int height) {
+    return new SkipTower{node,
+                         std::vector<SkipTower*>(static_cast<size_t>(height), nullptr),
+                         std::vector<size_t>(static_cast<size_t>(height), 0)};
+}
+
+/**
+ * SkipDescend - Walks from the top express level down to level 1. On each level
+ * it follows forward pointers while goRight(nextTower, positionAfterJump) says so.
+ * Records the last tower of each level in update[] (and its position in rank[])
+ * when those are given. Returns the last tower reached; `pos` is its position.
+ */
+template <class GoRight>
+static SkipTower* SkipDescend(const SkipList* sl, GoRight goRight,
+                              SkipTower** update, size_t* rank, size_t& pos) {
+    SkipTower* x = sl->head;
+    pos = 0;
+    for (int L = sl->levels - 1; L >= 0; --L) {
+        while (x->forward[L] != nullptr && goRight(x->forward[L], pos + x->span[L])) {
+            pos += x->span[L];
+            x = x->forward[L];
+        }
+        if (update) update[L] = x;
+        if (rank) rank[L] = pos;
+    }
+    return x;
+}
+
+/** First list node after the tower x (the head tower sits before list->head). */
+static Node* SkipFirstAfter(const SkipList* sl, const SkipTower* x) {
+    return (x->node == nullptr) ? sl->list->head : x->node->next;
+}
+
+/**
+ * SkipListBuild - Lays a skip list over an already SORTED list in one pass.
+ * The list keeps owning its nodes; call SkipListFree to drop the towers.
+ *
+ * Time: O(n), Space: O(n) expected towers (1/3 of the nodes at p = 1/4)
+ */
+void SkipListBuild(SkipList* sl, List* list) {
+    sl->list = list;
+    sl->head = SkipNewTower(nullptr, SKIP_MAX_LEVELS);
+    sl->levels = 0;
+    sl->size = 0;
+
+    /* last[L] is the most recent tower on level L, at position lastPos[L]. */
+    SkipTower* last[SKIP_MAX_LEVELS];
+    size_t lastPos[SKIP_MAX_LEVELS];
+    std::fill(last, last + SKIP_MAX_LEVELS, sl->head);
+    std::fill(lastPos, lastPos + SKIP_MAX_LEVELS, size_t{0});
+
+    for (Node* curr = list->head; curr != nullptr; curr = curr->next) {
+        const size_t pos = ++sl->size;
+        const int height = SkipRandomHeight(sl);
+        if (height == 0) continue;
+
+        SkipTower* tower = SkipNewTower(curr, height);
+        for (int L = 0; L < height; ++L) {
+            last[L]->forward[L] = tower;
+            last[L]->span[L] = pos - lastPos[L];
+            last[L] = tower;
+            lastPos[L] = pos;
+        }
+        sl->levels = std::max(sl->levels, height);
+    }
+
+    /* Pointers that run off the end count the nodes left until the end. */
+    for (int L = 0; L < SKIP_MAX_LEVELS; ++L) {
+        last[L]->span[L] = sl->size - lastPos[L];
+    }
+}
+
+/**
+ * SkipListFree - Deletes the towers. The list and its nodes are left untouched.
+ */
+void SkipListFree(SkipList* sl) {
+    if (sl->head == nullptr) return;
+    SkipTower* tower = sl->head;
+    while (tower != nullptr) {
+        /* Every tower has level 0, so level 0 visits each exactly once. */
+        SkipTower* next = tower->forward.empty() ? nullptr : tower->forward[0];
+        delete tower;
+        tower = next;
+    }
+    sl->head = nullptr;
+    sl->levels = 0;
+    sl->size = 0;
+}
+
+/**
+ * SkipListNth - The node at 0-based position k, or nullptr if k >= size.
+ *
+ * Time: O(log n) expected
+ */
+Node* SkipListNth(const SkipList* sl, size_t k) {
+    if (k >= sl->size) return nullptr;
+    const size_t target = k + 1;  /* positions are 1-based, the head tower is 0 */
+
+    size_t pos = 0;
+    SkipTower* x = SkipDescend(sl,
+        [target](const SkipTower*, size_t after) { return after <= target; },
+        nullptr, nullptr, pos);
+
+    /* Finish on level 0: only a few nodes are left between towers. */
+    Node* curr = SkipFirstAfter(sl, x);
+    if (x->node != nullptr && pos == target) return x->node;
+    for (++pos; pos < target; ++pos) curr = curr->next;
+    return curr;
+}
+
+/**
+ * SkipListRank - How many nodes have a key smaller than value, i.e. the 0-based
+ * position where value would be inserted in front of its equals.
+ *
+ * Time: O(log n) expected
+ */
+size_t SkipListRank(const SkipList* sl, int value) {
+    size_t pos = 0;
+    SkipTower* x = SkipDescend(sl,
+        [value](const SkipTower* t, size_t) { return t->node->data < value; },
+        nullptr, nullptr, pos);
+
+    for (const Node* curr = SkipFirstAfter(sl, x); curr != nullptr && curr->data < value;
+         curr = curr->next) {
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+ * SkipListInsert - Inserts a detached node after all nodes with an equal key
+ * (stable), linking it into both the list and the express levels.
+ *
+ * Time: O(log n) expected
+ */
+void SkipListInsert(SkipList* sl, Node* node) {
+    SkipTower* update[SKIP_MAX_LEVELS];
+    size_t rank[SKIP_MAX_LEVELS];
+    const int value = node->data;
+
+    size_t pos = 0;
+    SkipTower* x = SkipDescend(sl,
+        [value](const SkipTower* t, size_t) { return t->node->data <= value; },
+        update, rank, pos);
+
+    /* Level 0: find the last node <= value, exactly like FindInsertionSpot with <=. */
+    Node* prev = x->node;
+    for (Node* curr = SkipFirstAfter(sl, x); curr != nullptr && curr->data <= value;
+         curr = curr->next) {
+        prev = curr;
+        ++pos;
+    }
+    if (prev == nullptr) {
+        ListPrepend(sl->list, node);
+    } else {
+        ListInsertAfter(sl->list, prev, node);
+    }
+    /* The new node now sits at position pos + 1. */
+
+    const int height = SkipRandomHeight(sl);
+    for (int L = sl->levels; L < height; ++L) {
+        /* Brand-new levels start out as one jump from the head to the end. */
+        update[L] = sl->head;
+        rank[L] = 0;
+        sl->head->span[L] = sl->size;
+    }
+    sl->levels = std::max(sl->levels, height);
+
+    if (height > 0) {
+        SkipTower* tower = SkipNewTower(node, height);
+        for (int L = 0; L < height; ++L) {
+            /*
+             * update[L] (at rank[L]) used to jump span nodes. Now it stops at the
+             * new tower, and the tower takes over the rest of the jump:
+             *
+             *   before:  update --------- span ----------> F
+             *   after:   update -- (pos+1-rank) --> T -- (span-(pos-rank)) --> F
+             */
+            tower->forward[L] = update[L]->forward[L];
+            tower->span[L] = update[L]->span[L] - (pos - rank[L]);
+            update[L]->forward[L] = tower;
+            update[L]->span[L] = pos - rank[L] + 1;
+        }
+    }
+    /* Higher jumps pass over the new node, so they got one node longer. */
+    for (int L = height; L < sl->levels; ++L) {
+        ++update[L]->span[L];
+    }
+    ++sl->size;
+}
+
+/**
+ * SkipListRemove - Unlinks the first node with key == value from the list and
+ * the express levels and returns it (detached), or nullptr if there is none.
+ *
+ * Time: O(log n) expected
+ */
+Node* SkipListRemove(SkipList* sl, int value) {
+    SkipTower* update[SKIP_MAX_LEVELS];
+
+    size_t pos = 0;
+    SkipTower* x = SkipDescend(sl,
+        [value](const SkipTower* t, size_t) { return t->node->data < value; },
+        update, nullptr, pos);
+
+    Node* prev = x->node;
+    Node* curr = SkipFirstAfter(sl, x);
+    while (curr != nullptr && curr->data < value) {
+        prev = curr;
+        curr = curr->next;
+    }
+    if (curr == nullptr || curr->data != value) return nullptr;
+
+    /* If curr has a tower, it is the very next tower after update[0]. */
+    SkipTower* tower = nullptr;
+    if (sl->levels > 0 && update[0]->forward[0] != nullptr && update[0]->forward[0]->node == curr) {
+        tower = update[0]->forward[0];
+    }
+    for (int L = 0; L < sl->levels; ++L) {
+        if (tower != nullptr && update[L]->forward[L] == tower) {
+            /* Bridge over the tower: its jump is absorbed, minus the removed node. */
+            update[L]->span[L] += tower->span[L] - 1;
+            update[L]->forward[L] = tower->forward[L];
+        } else {
+            --update[L]->span[L];
+        }
+    }
+    delete tower;
+    while (sl->levels > 0 && sl->head->forward[sl->levels - 1] == nullptr) --sl->levels;
+
+    ListRemoveAfter(sl->list, prev);
+    --sl->size;
+    return curr;
+}
+
+/**
+ * SkipListSplit - Keeps the first k nodes in sl and moves the rest, together
+ * with their towers, into a new skip list `tail` over `tailList` (both are
+ * overwritten). Only one node per level is touched, so no walk over the tail.
+ *
+ * Time: O(log n) expected
+ */
+void SkipListSplit(SkipList* sl, size_t k, SkipList* tail, List* tailList) {
+    k = std::min(k, sl->size);
+    SkipTower* update[SKIP_MAX_LEVELS];
+    size_t rank[SKIP_MAX_LEVELS];
+
+    size_t pos = 0;
+    SkipTower* x = SkipDescend(sl,
+        [k](const SkipTower*, size_t after) { return after <= k; },
+        update, rank, pos);
+
+    tail->list = tailList;
+    tail->head = SkipNewTower(nullptr, SKIP_MAX_LEVELS);
+    tail->levels = sl->levels;
+    tail->size = sl->size - k;
+    tail->seed = sl->seed ^ 0x5bd1e995u;
+
+    for (int L = 0; L < sl->levels; ++L) {
+        /* The tail head takes over the jump that crosses the cut... */
+        tail->head->forward[L] = update[L]->forward[L];
+        tail->head->span[L] = rank[L] + update[L]->span[L] - k;
+        /* ...and the front part now ends right at the cut. */
+        update[L]->forward[L] = nullptr;
+        update[L]->span[L] = k - rank[L];
+    }
+
+    /* Cut level 0 after the node at position k. */
+    Node* last = x->node;
+    for (; pos < k; ++pos) last = (last == nullptr) ? sl->list->head : last->next;
+    if (last == nullptr) {
+        tailList->head = sl->list->head;
+        sl->list->head = nullptr;
+    } else {
+        tailList->head = last->next;
+        last->next = nullptr;
+    }
+
+    sl->size = k;
+    while (sl->levels > 0 && sl->head->forward[sl->levels - 1] == nullptr) --sl->levels;
+    while (tail->levels > 0 && tail->head->forward[tail->levels - 1] == nullptr) --tail->levels;
+}
+
+/*
+ * =============================================================================
+ * Priority Queue Over a Sorted List
+ * =============================================================================
+ */
+
+/**
+ * A PriorityQueue keeps its nodes in a sorted list, so the minimum is always
+ * the head and popping it is a single ListRemoveAfter(list, nullptr).
+ *
+ * Pushes do NOT search for their spot one at a time (that would be a
+ * FindInsertionSpot walk per push). They wait in `pending`, and right before the
+ * next pop the whole batch is sorted once and merged into the list:
+ *
+ *   push 7, push 2, push 9         pending: [7, 2, 9]     list: 1 -> 5
+ *   pop                            sort + merge =>        list: 1 -> 2 -> 5 -> 7 -> 9
+ *                                  returns 1
+ *
+ * Equal keys pop in the order they were pushed.
+ */
+struct PriorityQueue {
+    List list;                  /* sorted; the head is the minimum */
+    std::vector<Node*> pending; /* pushed since the last pop, not sorted yet */
+};
+
+/**
+ * PriorityQueuePush - Adds a detached node. O(1) amortized; the sorting is deferred.
+ */
+void PriorityQueuePush(PriorityQueue* pq, Node* node) {
+    pq->pending.push_back(node);
+}
+
+/**
+ * PriorityQueueFlush - Sorts the pending batch and merges it into the list.
+ * Called automatically by pop/peek; only useful directly to control when the cost is paid.
+ *
+ * Time: O(b log b + n) for b pending nodes
+ */
+void PriorityQueueFlush(PriorityQueue* pq) {
+    if (pq->pending.empty()) return;
+
+    /* stable_sort keeps equal keys in push order. */
+    std::stable_sort(pq->pending.begin(), pq->pending.end(),
+                     [](const Node* a, const Node* b) { return a->data < b->data; });
+
+    List batch;
+    Node* tail = nullptr;
+    for (Node* node : pq->pending) ListAppend(&batch, tail, node);
+    pq->pending.clear();
+
+    /* Older nodes win ties inside ListMerge, so earlier pushes still pop first. */
+    ListMerge(&pq->list, &batch);
+}
+
+/**
+ * PriorityQueuePopMin - Removes and returns the smallest node, or nullptr if empty.
+ *
+ * Time: O(1) when nothing is pending
+ */
+Node* PriorityQueuePopMin(PriorityQueue* pq) {
+    PriorityQueueFlush(pq);
+    return ListRemoveAfter(&pq->list, nullptr);
+}
+
+/**
+ * PriorityQueuePeekMin - The smallest node without removing it, or nullptr if empty.
+ */
+const Node* PriorityQueuePeekMin(PriorityQueue* pq) {
+    PriorityQueueFlush(pq);
+    return pq->list.head;
+}
+
+/** PriorityQueueEmpty - True when there is nothing to pop. */
+bool PriorityQueueEmpty(const PriorityQueue* pq) {
+    return pq->list.head == nullptr && pq->pending.empty();
+}
+
+/*
+ * =============================================================================
+ * Sliding-Window Median and Percentiles
+ * =============================================================================
+ */
+
+/**
+ * A SlidingWindow keeps the last `capacity` keys both in arrival order (to know
+ * which one expires next) and in a sorted list with a SkipList on top (to add,
+ * drop and read the k-th key in O(log W)).
+ *
+ *   capacity 3, push 5, 1, 9, 4:
+ *     arrivals: [5, 1, 9] -> 5 expires -> [1, 9, 4]
+ *     sorted:   1 -> 5 -> 9             ->  1 -> 4 -> 9      median = 4
+ *
+ * The node of the expiring key is reused for the new key, so a full window
+ * never allocates. The window points into itself: do not copy it.
+ */
+struct SlidingWindow {
+    List sorted;
+    SkipList index;            /* laid over `sorted` */
+    std::deque<int> arrivals;  /* oldest key at the front */
+    size_t capacity = 0;
+};
+
+/** SlidingWindowInit - Prepares an empty window holding at most `capacity` keys. */
+void SlidingWindowInit(SlidingWindow* w, size_t capacity) {
+    assert(capacity > 0 && "A window must hold at least one key");
+    w->capacity = capacity;
+    SkipListBuild(&w->index, &w->sorted);
+}
+
+/**
+ * SlidingWindowPush - Adds a key; once the window is full the oldest key leaves.
+ *
+ * Time: O(log W) expected
+ */
+void SlidingWindowPush(SlidingWindow* w, int key) {
+    Node* node = nullptr;
+    if (w->arrivals.size() == w->capacity) {
+        /* Any node with the expiring key will do: equal keys are interchangeable here. */
+        node = SkipListRemove(&w->index, w->arrivals.front());
+        w->arrivals.pop_front();
+        node->data = key;
+    } else {
+        node = new Node(key);
+    }
+    SkipListInsert(&w->index, node);
+    w->arrivals.push_back(key);
+}
+
+/**
+ * SlidingWindowQuantile - The key at 0-based sorted position round(p * (n - 1)),
+ * with p in [0, 1]: p = 0 is the minimum, 0.99 is p99, 1 is the maximum.
+ * The window must not be empty.
+ *
+ * Time: O(log W) expected
+ */
+int SlidingWindowQuantile(const SlidingWindow* w, double p) {
+    assert(w->index.size > 0 && "Quantile of an empty window");
+    p = std::clamp(p, 0.0, 1.0);
+    const size_t k = static_cast<size_t>(p * static_cast<double>(w->index.size - 1) + 0.5);
+    return SkipListNth(&w->index, k)->data;
+}
+
+/**
+ * SlidingWindowMedian - The middle key, or the mean of the two middle keys when
+ * the window holds an even number of keys. The window must not be empty.
+ *
+ * Time: O(log W) expected
+ */
+double SlidingWindowMedian(const SlidingWindow* w) {
+    const size_t n = w->index.size;
+    assert(n > 0 && "Median of an empty window");
+    const Node* upper = SkipListNth(&w->index, n / 2);
+    if (n % 2 == 1) return upper->data;
+    /* Even size: the lower middle is the node at n/2 - 1. */
+    const Node* lower = SkipListNth(&w->index, n / 2 - 1);
+    return (static_cast<double>(lower->data) + upper->data) / 2.0;
+}
+
+/** SlidingWindowFree - Deletes the window's nodes and towers. */
+void SlidingWindowFree(SlidingWindow* w) {
+    SkipListFree(&w->index);
+    Node* curr = w->sorted.head;
+    while (curr != nullptr) {
+        Node* next = curr->next;
+        delete curr;
+        curr = next;
+    }
+    w->sorted.head = nullptr;
+    w->arrivals.clear();
+}
+
+/*
+ * =============================================================================
+ * Approximate Quantile Sketch (KLL)
+ * =============================================================================
+ */
+
+/**
+ * A QuantileSketch answers "what is p99?" after ONE pass over the keys, without
+ * sorting them and with memory that stays under about 3k keys no matter how many it sees.
+ *
+ * It is a KLL sketch: a stack of "compactors". Level h holds keys that each
+ * stand for 2^h original keys. When a level gets full it is sorted, and every
+ * other key (odd or even positions, chosen at random) moves up one level while
+ * the rest are thrown away:
+ *
+ *   level 0 (weight 1): [2 3 5 7 8 9]  full -> sort, keep odd positions
+ *   level 1 (weight 2): [3 7 9]        each now counts twice
+ *
+ * Lower levels get smaller capacities (k * (2/3)^depth, but at least 8), so
+ * most of the memory goes to the heavy keys that matter most for accuracy.
+ * Two sketches with the same k can be merged, e.g. one per shard.
+ */
+struct QuantileSketch {
+    size_t k = 200;                        /* accuracy knob, see QuantileSketchError */
+    std::vector<std::vector<int>> levels;  /* levels[h]: keys of weight 2^h */
+    uint64_t count = 0;                    /* keys seen */
+    uint32_t seed = 0x2545F491u;
+};
+
+static constexpr size_t SKETCH_MIN_WIDTH = 8;
+
+/** Capacity of level h when the sketch has `height` levels (the top one gets k). */
+static size_t SketchCapacity(const QuantileSketch* sketch, size_t h) {
+    const size_t depth = sketch->levels.size() - 1 - h;
+    const double cap = std::ceil(static_cast<double>(sketch->k) * std::pow(2.0 / 3.0, static_cast<double>(depth)));
+    return std::max(SKETCH_MIN_WIDTH, static_cast<size_t>(cap));
+}
+
+/** Compacts levels until the sketch fits in its total capacity again. */
+static void SketchCompress(QuantileSketch* sketch) {
+    for (;;) {
+        size_t stored = 0;
+        size_t capacity = 0;
+        for (size_t h = 0; h < sketch->levels.size(); ++h) {
+            stored += sketch->levels[h].size();
+            capacity += SketchCapacity(sketch, h);
+        }
+        if (stored <= capacity) return;
+
+        /* Compact the lowest level that is full. */
+        size_t h = 0;
+        while (sketch->levels[h].size() < SketchCapacity(sketch, h)) ++h;
+        if (h + 1 == sketch->levels.size()) sketch->levels.emplace_back();
+
+        std::vector<int>& level = sketch->levels[h];
+        std::vector<int>& above = sketch->levels[h + 1];
+        std::sort(level.begin(), level.end());
+
+        /* With an odd count the first key stays behind; the rest pair up. */
+        const size_t first = level.size() % 2;
+        sketch->seed ^= sketch->seed << 13;
+        sketch->seed ^= sketch->seed >> 17;
+        sketch->seed ^= sketch->seed << 5;
+        const size_t offset = sketch->seed & 1u;
+        for (size_t i = first + offset; i < level.size(); i += 2) above.push_back(level[i]);
+        level.resize(first);
+    }
+}
+
+/**
+ * QuantileSketchUpdate - Adds one key.
+ *
+ * Time: O(1) amortized (plus an occasional sort of one level)
+ */
+void QuantileSketchUpdate(QuantileSketch* sketch, int value) {
+    if (sketch->levels.empty()) sketch->levels.emplace_back();
+    sketch->levels[0].push_back(value);
+    ++sketch->count;
+    if (sketch->levels[0].size() >= SketchCapacity(sketch, 0)) SketchCompress(sketch);
+}
+
+/**
+ * QuantileSketchMerge - Folds `other` into `sketch`. Both must use the same k.
+ */
+void QuantileSketchMerge(QuantileSketch* sketch, const QuantileSketch* other) {
+    assert(sketch->k == other->k && "Only sketches with the same k can be merged");
+    if (sketch->levels.size() < other->levels.size()) sketch->levels.resize(other->levels.size());
+    for (size_t h = 0; h < other->levels.size(); ++h) {
+        sketch->levels[h].insert(sketch->levels[h].end(),
+                                 other->levels[h].begin(), other->levels[h].end());
+    }
+    sketch->count += other->count;
+    if (!sketch->levels.empty()) SketchCompress(sketch);
+}
+
+/**
+ * ListQuantileSketch - Builds a sketch in one pass over the list. The list does
+ * not need to be sorted and is not modified.
+ *
+ * Time: O(n), Space: O(k)
+ */
+QuantileSketch ListQuantileSketch(const List* list, size_t k = 200) {
+    QuantileSketch sketch;
+    sketch.k = std::max(k, SKETCH_MIN_WIDTH);
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next) {
+        QuantileSketchUpdate(&sketch, curr->data);
+    }
+    return sketch;
+}
+
+/**
+ * QuantileSketchError - The rank error to expect for a given k, as a fraction of n.
+ * This is the empirical KLL bound published with Apache DataSketches: with about
+ * 99% confidence every rank is off by at most this much (k = 200 gives ~1.3%).
+ */
+double QuantileSketchError(size_t k) {
+    return 2.296 / std::pow(static_cast<double>(k), 0.9723);
+}
+
+/** All stored keys sorted by value, each with its weight. */
+static std::vector<std::pair<int, uint64_t>> SketchWeightedKeys(const QuantileSketch* sketch) {
+    std::vector<std::pair<int, uint64_t>> items;
+    for (size_t h = 0; h < sketch->levels.size(); ++h) {
+        for (int value : sketch->levels[h]) items.emplace_back(value, uint64_t{1} << h);
+    }
+    std::sort(items.begin(), items.end());
+    return items;
+}
+
+/**
+ * QuantileSketchValueAt - Approximate p-quantile, p in [0, 1] (0.5 = median,
+ * 0.999 = p999). The sketch must not be empty.
+ */
+int QuantileSketchValueAt(const QuantileSketch* sketch, double p) {
+    assert(sketch->count > 0 && "Quantile of an empty sketch");
+    const std::vector<std::pair<int, uint64_t>> items = SketchWeightedKeys(sketch);
+
+    /* The weights of the stored keys add up to the number of keys seen. */
+    uint64_t total = 0;
+    for (const auto& item : items) total += item.second;
+    const double target = std::clamp(p, 0.0, 1.0) * static_cast<double>(total);
+
+    uint64_t seen = 0;
+    for (const auto& item : items) {
+        seen += item.second;
+        if (static_cast<double>(seen) >= target) return item.first;
+    }
+    return items.back().first;
+}
+
+/**
+ * QuantileSketchRank - Approximate fraction of keys that are smaller than value.
+ */
+double QuantileSketchRank(const QuantileSketch* sketch, int value) {
+    uint64_t below = 0;
+    uint64_t total = 0;
+    for (size_t h = 0; h < sketch->levels.size(); ++h) {
+        for (int v : sketch->levels[h]) {
+            total += uint64_t{1} << h;
+            if (v < value) below += uint64_t{1} << h;
+        }
+    }
+    return (total == 0) ? 0.0 : static_cast<double>(below) / static_cast<double>(total);
+}
+
+/*
+ * =============================================================================
+ * Disorder Metrics
+ * =============================================================================
+ */
+
+/**
+ * DisorderStats describes how far a list is from sorted. Nothing here changes the list.
+ *
+ *   [ 1 ] -> [ 4 ] -> [ 2 ] -> [ 3 ] -> [ 9 ] -> [ 7 ]
+ *   inversions      = 3   (4>2, 4>3, 9>7)
+ *   runs            = 3   ([1 4] [2 3 9] [7])
+ *   maxDisplacement = 2   (4 sits at index 1 but belongs at index 3)
+ *   sortedPrefix    = 2   ([1 4])
+ *
+ * A cost note for choosing an engine: ListInsertionSort scans from the head,
+ * so it makes roughly n(n-1)/2 - inversions comparisons. Its slowest input is
+ * an already sorted list, not a reversed one.
+ */
+struct DisorderStats {
+    size_t length = 0;
+    uint64_t inversions = 0;     /* pairs i < j with key[i] > key[j] */
+    size_t runs = 0;             /* maximal non-decreasing runs (1 if sorted, 0 if empty) */
+    size_t maxDisplacement = 0;  /* farthest any node is from its stable sorted index */
+    size_t sortedPrefix = 0;     /* length of the longest non-decreasing prefix */
+};
+
+/** Sorts keys[lo, hi) with a merge sort and returns how many inversions it undid. */
+static uint64_t MergeCountInversions(std::vector<int>& keys, std::vector<int>& scratch,
+                                     size_t lo, size_t hi) {
+    if (hi - lo < 2) return 0;
+    const size_t mid = lo + (hi - lo) / 2;
+    uint64_t inversions = MergeCountInversions(keys, scratch, lo, mid) +
+                          MergeCountInversions(keys, scratch, mid, hi);
+
+    size_t i = lo;
+    size_t j = mid;
+    size_t out = lo;
+    while (i < mid && j < hi) {
+        if (keys[j] < keys[i]) {
+            /* keys[j] jumps ahead of everything still waiting on the left. */
+            inversions += mid - i;
+            scratch[out++] = keys[j++];
+        } else {
+            scratch[out++] = keys[i++];
+        }
+    }
+    while (i < mid) scratch[out++] = keys[i++];
+    while (j < hi) scratch[out++] = keys[j++];
+    std::copy(scratch.begin() + static_cast<std::ptrdiff_t>(lo),
+              scratch.begin() + static_cast<std::ptrdiff_t>(hi),
+              keys.begin() + static_cast<std::ptrdiff_t>(lo));
+    return inversions;
+}
+
+/**
+ * ListCountInversions - Counts pairs of nodes that are out of order, working on
+ * a copy of the keys so the list itself is untouched.
+ *
+ * Time: O(n log n), Space: O(n)
+ */
+uint64_t ListCountInversions(const List* list) {
+    std::vector<int> keys;
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next) keys.push_back(curr->data);
+    std::vector<int> scratch(keys.size());
+    return MergeCountInversions(keys, scratch, 0, keys.size());
+}
+
+/**
+ * ListDisorder - All DisorderStats for the list. The runs and the sorted prefix
+ * come from one O(n) walk; inversions and displacement need O(n log n).
+ */
+DisorderStats ListDisorder(const List* list) {
+    DisorderStats stats;
+    std::vector<int> keys;
+
+    bool inPrefix = true;
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next) {
+        /* A drop between neighbours ends a run (and the sorted prefix, the first time). */
+        if (keys.empty() || curr->data < keys.back()) {
+            ++stats.runs;
+            if (!keys.empty()) inPrefix = false;
+        }
+        if (inPrefix) ++stats.sortedPrefix;
+        keys.push_back(curr->data);
+    }
+    stats.length = keys.size();
+
+    /* Stable sorted position of every index: displacement = |where it is - where it goes|. */
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+    for (size_t pos = 0; pos < order.size(); ++pos) {
+        const size_t from = order[pos];
+        stats.maxDisplacement = std::max(stats.maxDisplacement, from > pos ? from - pos : pos - from);
+    }
+
+    std::vector<int> scratch(keys.size());
+    stats.inversions = MergeCountInversions(keys, scratch, 0, keys.size());
+    return stats;
+}
+
+/*
+ * =============================================================================
+ * k-Sorted Sort (bounded disorder)
+ * =============================================================================
+ */
+
+/**
+ * ListKSortedSort - Sorts a list in which every node is at most k positions away
+ * from where it belongs (e.g. timestamps that arrive a little late).
+ *
+ * A min-heap holds a sliding window of the next k+1 nodes. Its minimum must be
+ * the next node of the output, because anything smaller would have to be more
+ * than k positions later. We pop it, append it, and pull in one more node:
+ *
+ *   k = 2, input 3 1 2 6 4 5
+ *   heap {3 1 2} -> emit 1, pull 6 -> heap {3 2 6} -> emit 2, pull 4 -> ...
+ *
+ * Equal keys leave the heap in input order, so the sort is stable. Returns false
+ * if the output is not fully sorted (a node arrived more than k positions late);
+ * the list then still holds every node. Breaking the bound the other way (a
+ * node arriving early, like 9 in 9 1 2 3 4 with k = 1) is harmless: it just
+ * waits in the heap, and the result is sorted and true.
+ *
+ * Time: O(n log k), Space: O(min(k, n))
+ */
+bool ListKSortedSort(List* list, size_t k) {
+    struct Entry {
+        Node* node;
+        size_t seq;  /* input position, breaks ties so equal keys stay in order */
+    };
+    /* std heap functions build a max-heap, so "less" means "comes out later". */
+    auto comesLater = [](const Entry& a, const Entry& b) {
+        if (a.node->data != b.node->data) return a.node->data > b.node->data;
+        return a.seq > b.seq;
+    };
+
+    std::vector<Entry> heap;
+    heap.reserve(std::min<size_t>(k, 4095) + 1);  /* k is only a bound: a generous one must not allocate k slots */
+    Node* input = list->head;
+    Node* tail = nullptr;
+    size_t seq = 0;
+    bool sorted = true;
+    list->head = nullptr;
+
+    while (input != nullptr || !heap.empty()) {
+        /* Top the window up to k+1 nodes. */
+        while (input != nullptr && heap.size() <= k) {
+            Node* next = input->next;
+            heap.push_back({input, seq++});
+            std::push_heap(heap.begin(), heap.end(), comesLater);
+            input = next;
+        }
+
+        std::pop_heap(heap.begin(), heap.end(), comesLater);
+        Node* smallest = heap.back().node;
+        heap.pop_back();
+
+        if (tail != nullptr && smallest->data < tail->data) sorted = false;
+        ListAppend(list, tail, smallest);
+    }
+    return sorted;
+}
+
+/*
+ * =============================================================================
+ * Reorder Buffer (event-time watermark)
+ * =============================================================================
+ */
+
+/**
+ * A ReorderBuffer takes nodes that arrive slightly out of order and hands them
+ * out in sorted order once the caller promises nothing older will come: the
+ * watermark. Pending nodes wait in a sorted list; advancing the watermark cuts
+ * the whole prefix below it off the front in one go.
+ *
+ *   pending: [ 3 ] -> [ 4 ] -> [ 6 ] -> [ 8 ]      advance watermark to 6
+ *            \_ released _/
+ *   out:     [ 3 ] -> [ 4 ]       pending: [ 6 ] -> [ 8 ]
+ *
+ * Memory stays bounded by how far arrivals run ahead of the watermark.
+ */
+struct ReorderBuffer {
+    List pending;          /* sorted by key; equal keys in arrival order */
+    Node* tail = nullptr;  /* last pending node, so in-order arrivals append in O(1) */
+    size_t size = 0;       /* pending nodes */
+    int watermark = std::numeric_limits<int>::min();  /* every key below it was released */
+};
+
+/**
+ * ReorderBufferPush - Adds a detached node. Returns false (and leaves the node
+ * with the caller) if it is late: its key is below the current watermark.
+ *
+ * Time: O(1) for in-order arrivals, otherwise O(pending)
+ */
+bool ReorderBufferPush(ReorderBuffer* rb, Node* node) {
+    if (node->data < rb->watermark) return false;
+
+    if (rb->tail == nullptr || node->data >= rb->tail->data) {
+        /* The common case: not older than anything pending. */
+        ListAppend(&rb->pending, rb->tail, node);
+    } else {
+        /* Slot it in after the last pending node with a key <= its own. */
+        Node* spot = nullptr;
+        for (Node* curr = rb->pending.head; curr != nullptr && curr->data <= node->data;
+             curr = curr->next) {
+            spot = curr;
+        }
+        if (spot == nullptr) {
+            ListPrepend(&rb->pending, node);
+        } else {
+            ListInsertAfter(&rb->pending, spot, node);
+        }
+    }
+    ++rb->size;
+    return true;
+}
+
+/**
+ * ReorderBufferAdvance - Raises the watermark and moves every pending node with
+ * a key below it to the end of `out`, already sorted. A lower watermark than the
+ * current one is ignored. Returns how many nodes were released.
+ *
+ * The caller keeps `outTail` pointing at the last node of `out` (nullptr while
+ * it is empty), as with ListAppend, so a long-lived output list is never walked.
+ * Finding the cut walks only the released nodes; the split itself is O(1).
+ */
+size_t ReorderBufferAdvance(ReorderBuffer* rb, int watermark, List* out, Node*& outTail) {
+    rb->watermark = std::max(rb->watermark, watermark);
+
+    Node* last = nullptr;
+    size_t released = 0;
+    for (Node* curr = rb->pending.head; curr != nullptr && curr->data < rb->watermark;
+         curr = curr->next) {
+        last = curr;
+        ++released;
+    }
+    if (last == nullptr) return 0;
+
+    /* Cut after `last`: head..last goes out, the rest stays pending. */
+    Node* releasedHead = rb->pending.head;
+    rb->pending.head = last->next;
+    last->next = nullptr;
+    if (rb->pending.head == nullptr) rb->tail = nullptr;
+    rb->size -= released;
+
+    if (outTail == nullptr) {
+        out->head = releasedHead;
+    } else {
+        outTail->next = releasedHead;
+    }
+    outTail = last;
+    return released;
+}
+
+/*
+ * =============================================================================
+ * Adaptive Sorted Set (list <-> balanced tree)
+ * =============================================================================
+ */
+
+/** Orders nodes by key; also compares a node with a bare key for lookups. */
+struct NodeKeyLess {
+    using is_transparent = void;
+    bool operator()(const Node* a, const Node* b) const { return a->data < b->data; }
+    bool operator()(const Node* a, int value) const { return a->data < value; }
+    bool operator()(int value, const Node* b) const { return value < b->data; }
+};
+
+/**
+ * An AdaptiveSet holds a sorted collection of nodes in whichever shape suits
+ * the current phase of the workload:
+ *
+ *   LIST mode: nodes linked in order. Scans are a plain walk of next pointers,
+ *              but each insert first walks to its spot (O(n)).
+ *   TREE mode: the same nodes indexed by a balanced search tree (std::multiset).
+ *              Inserts and removals are O(log n), but a scan hops between tree cells.
+ *
+ * A run of ADAPTIVE_TREE_AFTER inserts without a scan switches to the tree in
+ * O(n); the next scan relinks the nodes into a list in O(n). Nodes are never
+ * copied: the tree stores pointers to them, because a Node has a single link
+ * and no room for child pointers. Equal keys stay in insertion order.
+ */
+struct AdaptiveSet {
+    List list;                                /* the nodes while in list mode */
+    std::multiset<Node*, NodeKeyLess> tree;   /* the nodes while in tree mode */
+    bool treeMode = false;
+    size_t size = 0;
+    size_t insertsSinceScan = 0;
+};
+
+static constexpr size_t ADAPTIVE_TREE_AFTER = 16;    /* inserts in a row before switching */
+static constexpr size_t ADAPTIVE_MIN_TREE_SIZE = 64; /* smaller sets just stay a list */
+
+/** Moves every node from the list into the tree, in order. Time: O(n) */
+static void AdaptiveToTree(AdaptiveSet* set) {
+    for (Node* curr = set->list.head; curr != nullptr; curr = curr->next) {
+        /* Appending with an end() hint costs O(1) amortized, and keeps equal keys in order. */
+        set->tree.insert(set->tree.end(), curr);
+    }
+    set->list.head = nullptr;
+    set->treeMode = true;
+}
+
+/** Relinks the tree's nodes into the list, in order. Time: O(n) */
+static void AdaptiveToList(AdaptiveSet* set) {
+    Node* tail = nullptr;
+    for (Node* node : set->tree) ListAppend(&set->list, tail, node);
+    set->tree.clear();
+    set->treeMode = false;
+}
+
+/**
+ * AdaptiveSetInsert - Adds a detached node after any nodes with an equal key.
+ *
+ * Time: O(log n) in tree mode, O(n) in list mode
+ */
+void AdaptiveSetInsert(AdaptiveSet* set, Node* node) {
+    ++set->size;
+    ++set->insertsSinceScan;
+    if (!set->treeMode && set->insertsSinceScan >= ADAPTIVE_TREE_AFTER &&
+        set->size >= ADAPTIVE_MIN_TREE_SIZE) {
+        AdaptiveToTree(set);
+    }
+
+    if (set->treeMode) {
+        set->tree.insert(node);  /* multiset puts it after its equals */
+        return;
+    }
+
+    Node* spot = nullptr;
+    for (Node* curr = set->list.head; curr != nullptr && curr->data <= node->data; curr = curr->next) {
+        spot = curr;
+    }
+    if (spot == nullptr) {
+        ListPrepend(&set->list, node);
+    } else {
+        ListInsertAfter(&set->list, spot, node);
+    }
+}
+
+/**
+ * AdaptiveSetRemove - Unlinks and returns the first node with key == value,
+ * or nullptr if there is none.
+ *
+ * Time: O(log n) in tree mode, O(n) in list mode
+ */
+Node* AdaptiveSetRemove(AdaptiveSet* set, int value) {
+    Node* found = nullptr;
+    if (set->treeMode) {
+        auto it = set->tree.lower_bound(value);
+        if (it == set->tree.end() || (*it)->data != value) return nullptr;
+        found = *it;
+        set->tree.erase(it);
+        found->next = nullptr;
+    } else {
+        Node* prev = nullptr;
+        Node* curr = set->list.head;
+        while (curr != nullptr && curr->data < value) {
+            prev = curr;
+            curr = curr->next;
+        }
+        if (curr == nullptr || curr->data != value) return nullptr;
+        found = ListRemoveAfter(&set->list, prev);
+    }
+    --set->size;
+    return found;
+}
+
+/**
+ * AdaptiveSetFind - The first node with key == value, or nullptr. Does not switch modes.
+ */
+Node* AdaptiveSetFind(const AdaptiveSet* set, int value) {
+    if (set->treeMode) {
+        auto it = set->tree.lower_bound(value);
+        return (it != set->tree.end() && (*it)->data == value) ? *it : nullptr;
+    }
+    Node* curr = set->list.head;
+    while (curr != nullptr && curr->data < value) curr = curr->next;
+    return (curr != nullptr && curr->data == value) ? curr : nullptr;
+}
+
+/**
+ * AdaptiveSetScan - Returns the nodes as a sorted list for a sequential walk,
+ * converting back from the tree first if needed. The list stays valid until
+ * the next insert or remove.
+ */
+const List* AdaptiveSetScan(AdaptiveSet* set) {
+    if (set->treeMode) AdaptiveToList(set);
+    set->insertsSinceScan = 0;
+    return &set->list;
+}
+
+/** AdaptiveSetFree - Deletes every node in the set. */
+void AdaptiveSetFree(AdaptiveSet* set) {
+    if (set->treeMode) AdaptiveToList(set);
+    Node* curr = set->list.head;
+    while (curr != nullptr) {
+        Node* next = curr->next;
+        delete curr;
+        curr = next;
+    }
+    set->list.head = nullptr;
+    set->size = 0;
+    set->insertsSinceScan = 0;
+}
+
+/*
+ * =============================================================================
+ * String-Keyed Lists (inline key prefix)
+ * =============================================================================
+ */
+
+/**
+ * StringKeyPrefix - The first 8 bytes of a key packed big-endian into one
+ * integer, padded with zero bytes. Comparing two prefixes as numbers gives the
+ * same answer as comparing those bytes as strings.
+ *
+ *   "path/a" -> 0x706174682F610000
+ */
+inline uint64_t StringKeyPrefix(std::string_view key) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        const unsigned char byte = (i < key.size()) ? static_cast<unsigned char>(key[i]) : 0;
+        prefix = (prefix << 8) | byte;
+    }
+    return prefix;
+}
+
+/**
+ * A StringNode is a Node with a string key. Next to the key it keeps the key's
+ * first 8 bytes as an integer, so most comparisons are one integer compare on
+ * the node itself and never touch the string's heap buffer.
+ *
+ * VISUAL:
+ *   ┌──────────┬───────────┬────────┐
+ *   │ prefix   │ key       │ next*  │
+ *   │ (8 byte) │ (string)  │        │
+ *   └──────────┴───────────┴────────┘
+ *
+ * Key can be std::string (the node owns the text) or std::string_view (the
+ * text lives elsewhere and must outlive the node).
+ */
+template <class Key>
+struct BasicStringNode {
+    uint64_t prefix;
+    Key key;
+    BasicStringNode* next;
+    explicit BasicStringNode(Key k) : prefix(StringKeyPrefix(k)), key(std::move(k)), next(nullptr) {}
+};
+
+using StringNode = BasicStringNode<std::string>;
+using StringViewNode = BasicStringNode<std::string_view>;
+
+/** A list of string-keyed nodes; the same signpost as List. */
+template <class SNode>
+struct BasicStringList {
+    SNode* head = nullptr;
+};
+
+using StringList = BasicStringList<StringNode>;
+using StringViewList = BasicStringList<StringViewNode>;
+
+/**
+ * StringNodeLess - a->key < b->key, deciding on the cached prefixes when they differ.
+ * Only when the first 8 bytes match do we read the strings, and then we skip
+ * the 8 bytes that are already known to be equal.
+ */
+template <class SNode>
+bool StringNodeLess(const SNode* a, const SNode* b) {
+    if (a->prefix != b->prefix) return a->prefix < b->prefix;
+    const std::string_view x = a->key;
+    const std::string_view y = b->key;
+    if (x.size() >= 8 && y.size() >= 8) return x.substr(8) < y.substr(8);
+    return x < y;  /* a short key: zero padding alone cannot tell "ab" from "ab\0" */
+}
+
+/**
+ * StringFindInsertionSpot - FindInsertionSpot for string keys: the last node
+ * before `boundary` whose key is NOT greater than node's, or nullptr for the head.
+ * Stopping after equal keys (not before them) is what keeps the sort stable.
+ */
+template <class SNode>
+SNode* StringFindInsertionSpot(const BasicStringList<SNode>* list, const SNode* node, SNode* boundary) {
+    SNode* prev = nullptr;
+    SNode* curr = list->head;
+    while (curr != boundary && !StringNodeLess(node, curr)) {
+        prev = curr;
+        curr = curr->next;
+    }
+    return prev;
+}
+
+/**
+ * StringListInsertionSort - ListInsertionSort for string-keyed lists.
+ *
+ * Time: O(n^2), Space: O(1), Stable: Yes
+ */
+template <class SNode>
+void StringListInsertionSort(BasicStringList<SNode>* list) {
+    if (!list || !list->head || !list->head->next) {
+        return;
+    }
+    SNode* prev = list->head;
+    SNode* curr = prev->next;
+    while (curr != nullptr) {
+        SNode* next = curr->next;
+        SNode* spot = StringFindInsertionSpot(list, curr, /*boundary=*/curr);
+        if (spot == prev) {
+            prev = curr;
+        } else {
+            /* Unlink curr (it sits right after prev), then splice it in after spot. */
+            prev->next = next;
+            if (spot == nullptr) {
+                curr->next = list->head;
+                list->head = curr;
+            } else {
+                curr->next = spot->next;
+                spot->next = curr;
+            }
+        }
+        curr = next;
+    }
+}
+
+/**
+ * StringListMerge - ListMerge for string-keyed lists: merges the SORTED `other`
+ * into the SORTED `list`, stably; `other` is left empty.
+ *
+ * Time: O(n + m), Space: O(1)
+ */
+template <class SNode>
+void StringListMerge(BasicStringList<SNode>* list, BasicStringList<SNode>* other) {
+    SNode* a = list->head;
+    SNode* b = other->head;
+    SNode** link = &list->head;  /* where the next chosen node gets hooked in */
+    other->head = nullptr;
+
+    while (a != nullptr && b != nullptr) {
+        if (StringNodeLess(b, a)) {
+            *link = b;
+            b = b->next;
+        } else {
+            *link = a;
+            a = a->next;
+        }
+        link = &(*link)->next;
+    }
+    *link = (a != nullptr) ? a : b;
+}
+
+/** StringListFree - Deletes every node of a string-keyed list. */
+template <class SNode>
+void StringListFree(BasicStringList<SNode>* list) {
+    SNode* curr = list->head;
+    while (curr != nullptr) {
+        SNode* next = curr->next;
+        delete curr;
+        curr = next;
+    }
+    list->head = nullptr;
+}
+
+/*
+ * =============================================================================
+ * MSD Radix Sort for String-Keyed Lists
+ * =============================================================================
+ */
+
+static constexpr size_t STRING_RADIX_CUTOFF = 16;  /* smaller buckets use insertion sort */
+
+/**
+ * StringByteAt - Bucket number of a key at `depth`: 0 if the key has ended,
+ * otherwise 1 + the byte. The first 8 bytes come from the cached prefix.
+ */
+template <class SNode>
+static size_t StringByteAt(const SNode* node, size_t depth) {
+    if (depth >= node->key.size()) return 0;
+    if (depth < 8) return 1 + ((node->prefix >> (56 - 8 * depth)) & 0xFF);
+    return 1 + static_cast<unsigned char>(node->key[depth]);
+}
+
+/**
+ * StringRadixSortChain - Sorts a chain of `count` nodes whose keys all agree on
+ * their first `depth` bytes. Returns the new head and sets `tail`.
+ *
+ * 1. Small chain: plain insertion sort.
+ * 2. Skip the bytes every key still has in common (no point bucketing them).
+ * 3. Deal the nodes into 257 buckets by the byte at `depth` (bucket 0 = key ended).
+ * 4. Sort every bucket one byte deeper and chain the buckets back together.
+ *
+ *   depth 0:  "cat" "car" "dog" "cab"
+ *   'c' bucket: "cat" "car" "cab"  -> common prefix "ca", bucket on byte 2
+ *   'd' bucket: "dog"
+ */
+template <class SNode>
+static SNode* StringRadixSortChain(SNode* head, size_t count, size_t depth, SNode*& tail) {
+    if (count < STRING_RADIX_CUTOFF) {
+        BasicStringList<SNode> small;
+        small.head = head;
+        StringListInsertionSort(&small);
+        tail = small.head;
+        while (tail->next != nullptr) tail = tail->next;
+        return small.head;
+    }
+
+    /* Common prefix from depth on, measured against the first key. */
+    const std::string_view first = head->key;
+    size_t common = (first.size() > depth) ? first.size() - depth : 0;
+    for (const SNode* curr = head->next; curr != nullptr && common > 0; curr = curr->next) {
+        const std::string_view key = curr->key;
+        size_t same = 0;
+        while (same < common && depth + same < key.size() && key[depth + same] == first[depth + same]) ++same;
+        common = same;
+    }
+    depth += common;
+
+    /* Deal the nodes out, appending so equal bytes keep their order (stable). */
+    struct Bucket {
+        SNode* head = nullptr;
+        SNode* tail = nullptr;
+        size_t count = 0;
+    };
+    std::vector<Bucket> buckets(257);
+    for (SNode* curr = head; curr != nullptr;) {
+        SNode* next = curr->next;
+        Bucket& b = buckets[StringByteAt(curr, depth)];
+        curr->next = nullptr;
+        if (b.tail == nullptr) {
+            b.head = curr;
+        } else {
+            b.tail->next = curr;
+        }
+        b.tail = curr;
+        ++b.count;
+        curr = next;
+    }
+
+    /* Bucket 0 holds keys that ended here; they are all equal and already in order. */
+    SNode* sortedHead = nullptr;
+    tail = nullptr;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Bucket& b = buckets[i];
+        if (b.head == nullptr) continue;
+        SNode* bucketTail = b.tail;
+        SNode* bucketHead = (i == 0 || b.count == 1)
+                                ? b.head
+                                : StringRadixSortChain(b.head, b.count, depth + 1, bucketTail);
+        if (tail == nullptr) {
+            sortedHead = bucketHead;
+        } else {
+            tail->next = bucketHead;
+        }
+        tail = bucketTail;
+    }
+    return sortedHead;
+}
+
+/**
+ * StringListRadixSort - Most-significant-byte-first radix sort for string-keyed
+ * lists. Each byte of each key is looked at about once, instead of once per
+ * comparison as in a comparison sort, which pays off when many keys share long
+ * prefixes (URLs, paths).
+ *
+ * Time: O(total key bytes examined + n), Space: O(recursion depth * 257), Stable: Yes
+ */
+template <class SNode>
+void StringListRadixSort(BasicStringList<SNode>* list) {
+    size_t count = 0;
+    for (const SNode* curr = list->head; curr != nullptr; curr = curr->next) ++count;
+    if (count < 2) return;
+    SNode* tail = nullptr;
+    list->head = StringRadixSortChain(list->head, count, 0, tail);
+}
+
+/*
+ * =============================================================================
+ * Radix Sort for Numeric Keys
+ * =============================================================================
+ */
+
+/**
+ * OrderedBits - Turns a number into an unsigned integer of the same width whose
+ * plain unsigned order is the number's order, so radix sort can work on bits.
+ *
+ *   unsigned:  unchanged
+ *   signed:    flip the sign bit           (-1 -> 0x7FFF..., 0 -> 0x8000...)
+ *   float:     positive: set the sign bit; negative: flip every bit
+ *              (negatives get more negative as their magnitude grows)
+ *
+ * Floating-point ordering: -inf < ... < -0.0 < +0.0 < ... < +inf < NaN.
+ * Every NaN (any sign or payload) maps to the largest value, so NaNs go last.
+ */
+template <class T>
+auto OrderedBits(T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8, "float and double only");
+        using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        if (value != value) return ~U{0};  /* NaN */
+        const U bits = std::bit_cast<U>(value);
+        const U sign = U{1} << (8 * sizeof(U) - 1);
+        return (bits & sign) ? static_cast<U>(~bits) : static_cast<U>(bits | sign);
+    } else if constexpr (std::is_signed_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<U>(static_cast<U>(value) ^ (U{1} << (8 * sizeof(U) - 1)));
+    } else {
+        return value;
+    }
+}
+
+/**
+ * RadixDigitBits - How wide each digit (bucket index) should be for `count`
+ * nodes: wider digits mean fewer passes but more buckets to keep in cache.
+ */
+static unsigned RadixDigitBits(size_t count) {
+    if (count < (size_t{1} << 12)) return 8;
+    if (count < (size_t{1} << 22)) return 11;
+    return 16;
+}
+
+/**
+ * RadixSortChain - Stable LSD radix sort of a chain of `count` nodes on bits
+ * [lowBit, highBit) of OrderedBits(keyOf(node)). Returns the head; sets `tail`.
+ *
+ * First one walk builds the histogram of EVERY digit at once. A digit where all
+ * nodes land in the same bucket would not reorder anything, so its pass is
+ * skipped. Each remaining pass deals the nodes into bucket lists, appending so
+ * that equal digits keep their order, and chains the buckets back together.
+ *
+ *   keys 0x21 0x13 0x22 0x11, 4-bit digits
+ *   low pass:  [0x21 0x11] [0x22] [0x13]      (by 1, 2, 3)
+ *   high pass: [0x11 0x13] [0x21 0x22]        (by 1, 2)
+ */
+template <class KeyOf>
+static Node* RadixSortChain(Node* head, size_t count, KeyOf keyOf,
+                            unsigned lowBit, unsigned highBit, Node*& tail) {
+    using Bits = decltype(OrderedBits(keyOf(head)));
+    tail = nullptr;
+    if (head == nullptr) return nullptr;
+    if (count < 2 || highBit <= lowBit) {
+        for (tail = head; tail->next != nullptr;) tail = tail->next;
+        return head;
+    }
+
+    /* Split the bit range into passes of (nearly) equal width. */
+    const unsigned range = highBit - lowBit;
+    const unsigned maxWidth = std::min(RadixDigitBits(count), range);
+    const unsigned passes = (range + maxWidth - 1) / maxWidth;
+    const unsigned width = (range + passes - 1) / passes;
+    const size_t buckets = size_t{1} << width;
+    const Bits mask = static_cast<Bits>(buckets - 1);
+
+    /* Histogram pre-pass: counts[p * buckets + digit] for every pass p. */
+    std::vector<size_t> counts(passes * buckets, 0);
+    for (const Node* curr = head; curr != nullptr; curr = curr->next) {
+        const Bits bits = OrderedBits(keyOf(curr));
+        for (unsigned p = 0; p < passes; ++p) {
+            const unsigned shift = lowBit + p * width;
+            ++counts[p * buckets + ((bits >> shift) & mask)];
+        }
+    }
+
+    std::vector<Node*> heads(buckets);
+    std::vector<Node*> tails(buckets);
+    for (unsigned p = 0; p < passes; ++p) {
+        const size_t* hist = counts.data() + p * buckets;
+        const unsigned shift = lowBit + p * width;
+
+        /* Every key has the same digit here: the pass would change nothing. */
+        if (hist[(OrderedBits(keyOf(head)) >> shift) & mask] == count) continue;
+
+        std::fill(heads.begin(), heads.end(), nullptr);
+        for (Node* curr = head; curr != nullptr;) {
+            Node* next = curr->next;
+            const size_t digit = (OrderedBits(keyOf(curr)) >> shift) & mask;
+            curr->next = nullptr;
+            if (heads[digit] == nullptr) {
+                heads[digit] = curr;
+            } else {
+                tails[digit]->next = curr;
+            }
+            tails[digit] = curr;
+            curr = next;
+        }
+
+        /* Chain the non-empty buckets back together, smallest digit first. */
+        Node* last = nullptr;
+        for (size_t digit = 0; digit < buckets; ++digit) {
+            if (hist[digit] == 0) continue;
+            if (last == nullptr) {
+                head = heads[digit];
+            } else {
+                last->next = heads[digit];
+            }
+            last = tails[digit];
+        }
+    }
+
+    for (tail = head; tail->next != nullptr;) tail = tail->next;
+    return head;
+}
+
+/**
+ * ListRadixSortBy - Stable radix sort on keyOf(node), which may return any
+ * integer type (up to 64 bits), float or double. See OrderedBits for how
+ * negative numbers, -0.0 and NaN are ordered.
+ *
+ * Time: O(passes * n), where passes = key bits / digit bits (8, 11 or 16)
+ * minus the passes skipped; Space: O(2^digit bits), Stable: Yes
+ */
+template <class KeyOf>
+void ListRadixSortBy(List* list, KeyOf keyOf) {
+    size_t count = 0;
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next) ++count;
+    if (count < 2) return;
+
+    using Bits = decltype(OrderedBits(keyOf(list->head)));
+    Node* tail = nullptr;
+    list->head = RadixSortChain(list->head, count, keyOf, 0, 8 * sizeof(Bits), tail);
+}
+
+/**
+ * ListRadixSort - Stable radix sort on the node keys.
+ *
+ * Time: O(n) for 32-bit keys (at most 4 passes), Space: O(2^digit bits), Stable: Yes
+ */
+void ListRadixSort(List* list) {
+    ListRadixSortBy(list, [](const Node* n) { return n->data; });
+}
+
+/*
+ * =============================================================================
+ * Parallel Radix Sort
+ * =============================================================================
+ */
+
+static constexpr size_t PARALLEL_MIN_NODES_PER_THREAD = size_t{1} << 16;
+
+/** A chain of nodes being passed between the phases of the parallel sort. */
+struct NodeChain {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    size_t count = 0;
+};
+
+/** Appends a chain to the end of another one in O(1). */
+static void ChainAppend(NodeChain* chain, const NodeChain& more) {
+    if (more.head == nullptr) return;
+    if (chain->tail == nullptr) {
+        chain->head = more.head;
+    } else {
+        chain->tail->next = more.head;
+    }
+    chain->tail = more.tail;
+    chain->count += more.count;
+}
+
+/**
+ * ParallelStableSort - std::stable_sort on up to `threads` threads (0 = every
+ * hardware thread). Each thread sorts one slice, then neighbouring slices are
+ * merged pairwise, in parallel, until one is left:
+ *
+ *   [s0] [s1] [s2] [s3]  ->  [s0 s1] [s2 s3]  ->  [s0 s1 s2 s3]
+ *
+ * A merge takes the left slice first on ties, so the result is stable.
+ * Small inputs are sorted on the calling thread.
+ */
+template <class T, class Less>
+static void ParallelStableSort(std::vector<T>& items, Less less, unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(
+        std::min<size_t>(threads, items.size() / PARALLEL_MIN_NODES_PER_THREAD));
+    if (threads < 2) {
+        std::stable_sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    std::vector<size_t> cuts(threads + 1);
+    for (unsigned t = 0; t <= threads; ++t) cuts[t] = items.size() * t / threads;
+    auto slice = [&](size_t i) { return items.begin() + static_cast<std::ptrdiff_t>(cuts[i]); };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] { std::stable_sort(slice(t), slice(t + 1), less); });
+    }
+    for (std::thread& w : workers) w.join();
+
+    for (size_t width = 1; width < threads; width *= 2) {
+        workers.clear();
+        for (size_t t = 0; t + width < threads; t += 2 * width) {
+            const size_t last = std::min<size_t>(t + 2 * width, threads);
+            workers.emplace_back([&, t, width, last] { std::inplace_merge(slice(t), slice(t + width), slice(last), less); });
+        }
+        for (std::thread& w : workers) w.join();
+    }
+}
+
+/**
+ * ListParallelRadixSortBy - Multithreaded, stable LSD radix sort on keyOf(node)
+ * (same key types as ListRadixSortBy). The list is kept cut into one segment
+ * per thread, and EVERY digit pass is shared out evenly, whatever the keys are.
+ *
+ * Up front, each thread counts every digit of its own segment in one walk. A
+ * digit where all keys agree would not reorder anything, so its pass is
+ * skipped. Then, for each remaining pass:
+ *
+ * 1. OFFSETS (serial, tiny): walking the counts digit-major, thread-minor gives
+ *    every (thread, digit) bucket its position in the output, so each thread
+ *    knows which of its nodes will start a segment of the next pass.
+ * 2. SCATTER (parallel): each thread deals its segment into its own buckets and
+ *    counts the next pass's digit, per destination segment, on the way. That
+ *    is a threads^2 * 2^digit bits matrix, so it is only used while it stays
+ *    below one entry per 16 nodes (at 192 threads it would be ~600 MB, more
+ *    than the list); above that, each thread recounts its new segment in one
+ *    more walk after the stitch.
+ * 3. STITCH (serial, tiny): bucket d of thread 0, then of thread 1, ..., then
+ *    digit d + 1. Digit-major, thread-minor order keeps equal keys in list
+ *    order, so the sort stays stable. The result is already cut into equal
+ *    segments for the next pass.
+ *
+ *   thread 0: [d0: a b] [d1: c]      d0: a b e   d1: c f g
+ *   thread 1: [d0: e]   [d1: f g]    next pass:  [a b e] [c f g]
+ *
+ * Finding the first segment starts is one serial walk over the list. Lists too
+ * small to share out go to ListRadixSortBy. `threads` = 0 uses every hardware thread.
+ * If `boundaries` is given it receives the first node of every segment but the
+ * first, in list order (empty when the list was too small to share out), so
+ * ListVerify can check the result on the same threads.
+ *
+ * Time: O(passes * (n / threads + threads * 2^digit bits) + n),
+ * Space: O(threads * 2^digit bits + n / 16), Stable: Yes
+ */
+template <class KeyOf>
+void ListParallelRadixSortBy(List* list, KeyOf keyOf, unsigned threads = 0,
+                             std::vector<const Node*>* boundaries = nullptr) {
+    if (boundaries != nullptr) boundaries->clear();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    size_t count = 0;
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next) ++count;
+    threads = static_cast<unsigned>(
+        std::min<size_t>(threads, count / PARALLEL_MIN_NODES_PER_THREAD));
+    if (threads < 2) {
+        ListRadixSortBy(list, keyOf);
+        return;
+    }
+
+    using Bits = decltype(OrderedBits(keyOf(list->head)));
+    const unsigned keyBits = 8 * sizeof(Bits);
+    const unsigned maxWidth = std::min({RadixDigitBits(count), 11u, keyBits});
+    const unsigned passes = (keyBits + maxWidth - 1) / maxWidth;
+    const unsigned width = (keyBits + passes - 1) / passes;
+    const size_t buckets = size_t{1} << width;
+    const Bits mask = static_cast<Bits>(buckets - 1);
+    auto digitOf = [&](Bits bits, unsigned pass) { return static_cast<size_t>((bits >> (pass * width)) & mask); };
+
+    /* Segment s starts at node s * per and holds `per` nodes (the last one fewer). */
+    const size_t per = (count + threads - 1) / threads;
+    const size_t segments = (count + per - 1) / per;
+    std::vector<Node*> starts(segments);
+    {
+        Node* curr = list->head;
+        for (size_t s = 0; s < segments; ++s) {
+            starts[s] = curr;
+            for (size_t i = 0; i < per && curr != nullptr; ++i) curr = curr->next;
+        }
+    }
+    auto segmentSize = [&](size_t s) { return std::min(per, count - s * per); };
+    auto inParallel = [&](auto work) {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < segments; ++t) workers.emplace_back(work, t);
+        for (std::thread& w : workers) w.join();
+    };
+
+    /* Histogram of every digit, per segment: allCounts[(s * passes + p) * buckets + d]. */
+    std::vector<size_t> allCounts(segments * passes * buckets, 0);
+    inParallel([&](size_t s) {
+        size_t* hist = allCounts.data() + s * passes * buckets;
+        Node* curr = starts[s];
+        for (size_t i = segmentSize(s); i > 0; --i, curr = curr->next) {
+            const Bits bits = OrderedBits(keyOf(curr));
+            for (unsigned p = 0; p < passes; ++p) ++hist[p * buckets + digitOf(bits, p)];
+        }
+    });
+    std::vector<unsigned> active;
+    for (unsigned p = 0; p < passes; ++p) {
+        for (size_t d = 0; d < buckets; ++d) {
+            size_t total = 0;
+            for (size_t s = 0; s < segments; ++s) total += allCounts[(s * passes + p) * buckets + d];
+            if (total == count) break;  /* one digit holds every key */
+            if (total != 0) {
+                active.push_back(p);
+                break;
+            }
+        }
+    }
+    auto reportBoundaries = [&] {
+        if (boundaries != nullptr) boundaries->assign(starts.begin() + 1, starts.end());
+    };
+    if (active.empty()) {
+        reportBoundaries();
+        return;
+    }
+
+    /* counts[s * buckets + d]: nodes of segment s with digit d in the coming pass. */
+    std::vector<size_t> counts(segments * buckets);
+    for (size_t s = 0; s < segments; ++s) {
+        std::copy_n(allCounts.data() + (s * passes + active[0]) * buckets, buckets, counts.data() + s * buckets);
+    }
+    allCounts = std::vector<size_t>();
+
+    /* One bucket of one thread: its nodes, where they land, and the next segment start among them. */
+    struct Bucket {
+        NodeChain chain;
+        size_t position;   /* output position of the next node dealt into it */
+        size_t nextStart;  /* first multiple of `per` at or after position */
+        size_t segment;    /* next-pass segment that position falls in */
+    };
+    std::vector<Bucket> local(segments * buckets);
+    const bool fuseCounts = segments * segments * buckets <= count / 16;
+    std::vector<size_t> nextCounts(fuseCounts ? segments * segments * buckets : 0);  /* [thread][segment][digit] */
+    std::vector<Node*> nextStarts(segments);
+
+    for (size_t a = 0; a < active.size(); ++a) {
+        const unsigned pass = active[a];
+        const bool countNext = a + 1 < active.size();
+
+        /* 1. Offsets, digit-major then thread-minor. */
+        size_t position = 0;
+        for (size_t d = 0; d < buckets; ++d) {
+            for (size_t t = 0; t < segments; ++t) {
+                Bucket& b = local[t * buckets + d];
+                b.chain = NodeChain{};
+                b.position = position;
+                b.nextStart = (position + per - 1) / per * per;
+                b.segment = position / per;
+                position += counts[t * buckets + d];
+            }
+        }
+        if (countNext && fuseCounts) std::fill(nextCounts.begin(), nextCounts.end(), size_t{0});
+
+        /* 2. Scatter; a node landing on a multiple of `per` starts a new segment. */
+        inParallel([&](size_t t) {
+            Bucket* mine = local.data() + t * buckets;
+            size_t* next = fuseCounts ? nextCounts.data() + t * segments * buckets : nullptr;
+            Node* curr = starts[t];
+            for (size_t i = segmentSize(t); i > 0; --i) {
+                Node* after = curr->next;
+                const Bits bits = OrderedBits(keyOf(curr));
+                Bucket& b = mine[digitOf(bits, pass)];
+                if (b.position == b.nextStart) {
+                    b.segment = b.position / per;
+                    nextStarts[b.segment] = curr;
+                    b.nextStart += per;
+                }
+                ++b.position;
+                if (countNext && fuseCounts) ++next[b.segment * buckets + digitOf(bits, active[a + 1])];
+                ChainAppend(&b.chain, NodeChain{curr, curr, 1});
+                curr = after;
+            }
+        });
+
+        /* 3. Stitch digit-major, thread-minor. */
+        NodeChain result;
+        for (size_t d = 0; d < buckets; ++d) {
+            for (size_t t = 0; t < segments; ++t) ChainAppend(&result, local[t * buckets + d].chain);
+        }
+        result.tail->next = nullptr;
+        list->head = result.head;
+        starts.swap(nextStarts);
+
+        if (countNext && fuseCounts) {
+            std::fill(counts.begin(), counts.end(), size_t{0});
+            for (size_t t = 0; t < segments; ++t) {
+                for (size_t i = 0; i < segments * buckets; ++i) counts[i] += nextCounts[t * segments * buckets + i];
+            }
+        } else if (countNext) {
+            std::fill(counts.begin(), counts.end(), size_t{0});
+            inParallel([&](size_t s) {
+                size_t* hist = counts.data() + s * buckets;
+                Node* curr = starts[s];
+                for (size_t i = segmentSize(s); i > 0; --i, curr = curr->next) {
+                    ++hist[digitOf(OrderedBits(keyOf(curr)), active[a + 1])];
+                }
+            });
+        }
+    }
+    reportBoundaries();
+}
+
+/**
+ * ListParallelRadixSort - ListParallelRadixSortBy on the node keys.
+ */
+void ListParallelRadixSort(List* list, unsigned threads = 0, std::vector<const Node*>* boundaries = nullptr) {
+    ListParallelRadixSortBy(list, [](const Node* n) { return n->data; }, threads, boundaries);
+}
+
+/**
+ * ListSortByColumns - Sorts by several keys, most significant first, e.g.
+ *
+ *   ListSortByColumns(&list, tenantOf, priorityOf, timestampOf);
+ *
+ * Each key function may return any type ListRadixSortBy accepts. Instead of one
+ * comparator with an if-chain per column, this runs one stable radix sort per
+ * column, from the LEAST significant to the most. Every pass is stable, so
+ * nodes that tie on a column keep the order the earlier passes gave them:
+ *
+ *   (t=2,p=1) (t=1,p=3) (t=2,p=0)
+ *   by p:     (t=2,p=0) (t=2,p=1) (t=1,p=3)
+ *   by t:     (t=1,p=3) (t=2,p=0) (t=2,p=1)
+ *
+ * Low-cardinality columns are cheap: their constant high digits are skipped.
+ *
+ * Time: O(n * total passes), Stable: Yes
+ */
+template <class KeyOf>
+void ListSortByColumns(List* list, KeyOf keyOf) {
+    ListRadixSortBy(list, keyOf);
+}
+
+template <class KeyOf, class... MoreKeys>
+void ListSortByColumns(List* list, KeyOf keyOf, MoreKeys... moreKeys) {
+    ListSortByColumns(list, moreKeys...);  /* less significant columns first */
+    ListRadixSortBy(list, keyOf);
+}
+
+/*
+ * =============================================================================
+ * Cached-Key Sort (decorate, sort, undecorate)
+ * =============================================================================
+ */
+
+/**
+ * ListSortByCachedKey - Stable sort by keyOf(node) that calls keyOf exactly once
+ * per node. Use it when the key is expensive to compute (parsed from a payload,
+ * hashed, ...): a comparison sort would recompute it for every comparison.
+ *
+ * 1. Decorate: walk the list once into a side buffer of { key, node } pairs.
+ * 2. Sort the buffer; comparisons only read the cached keys.
+ * 3. Undecorate: relink the nodes in buffer order and drop the buffer.
+ *
+ *   list:   [A] -> [B] -> [C]
+ *   buffer: {7,A} {2,B} {5,C}  -> sorted {2,B} {5,C} {7,A}
+ *   list:   [B] -> [C] -> [A]
+ *
+ * The buffer is sorted with ParallelStableSort: `threads` = 1 (the default)
+ * stays on the calling thread, 0 uses every hardware thread.
+ *
+ * Time: n key computations + O(n log n) comparisons, Space: O(n), Stable: Yes
+ */
+template <class KeyOf>
+void ListSortByCachedKey(List* list, KeyOf keyOf, unsigned threads = 1) {
+    if (!list || !list->head || !list->head->next) {
+        return;
+    }
+
+    using Key = std::decay_t<decltype(keyOf(list->head))>;
+    struct Entry {
+        Key key;
+        Node* node;
+    };
+    std::vector<Entry> entries;
+    for (Node* curr = list->head; curr != nullptr; curr = curr->next) {
+        entries.push_back(Entry{keyOf(curr), curr});
+    }
+
+    ParallelStableSort(entries, [](const Entry& a, const Entry& b) { return a.key < b.key; }, threads);
+
+    Node* tail = nullptr;
+    for (const Entry& entry : entries) ListAppend(list, tail, entry.node);
+}
+
+/*
+ * =============================================================================
+ * Sorting With a Permutation (for columnar payloads)
+ * =============================================================================
+ */
+
+/**
+ * ListSortWithPermutation - Stable sort that also reports where every node came
+ * from. Nodes are numbered by their position when the call starts (0, 1, 2, ...),
+ * and the result says which original position now sits at each index:
+ *
+ *   before:  [30] -> [10] -> [20]        positions 0, 1, 2
+ *   after:   [10] -> [20] -> [30]        permutation = { 1, 2, 0 }
+ *
+ * Payload columns kept outside the list (parallel arrays built in list order)
+ * can then be brought into the same order with one ApplyPermutation each.
+ * `threads` works as in ListSortByCachedKey.
+ *
+ * Time: O(n log n), Space: O(n), Stable: Yes
+ */
+std::vector<size_t> ListSortWithPermutation(List* list, unsigned threads = 1) {
+    struct Entry {
+        int key;
+        size_t position;
+        Node* node;
+    };
+    std::vector<Entry> entries;
+    size_t position = 0;
+    for (Node* curr = list->head; curr != nullptr; curr = curr->next) {
+        entries.push_back(Entry{curr->data, position++, curr});
+    }
+
+    ParallelStableSort(entries, [](const Entry& a, const Entry& b) { return a.key < b.key; }, threads);
+
+    std::vector<size_t> permutation;
+    permutation.reserve(entries.size());
+    Node* tail = nullptr;
+    for (const Entry& entry : entries) {
+        ListAppend(list, tail, entry.node);
+        permutation.push_back(entry.position);
+    }
+    return permutation;
+}
+
+/**
+ * ApplyPermutation - Gathers a column into sorted order: out[i] = column[permutation[i]].
+ *
+ * Time: O(n), Space: O(n)
+ */
+template <class T>
+std::vector<T> ApplyPermutation(const std::vector<T>& column, const std::vector<size_t>& permutation) {
+    assert(column.size() == permutation.size() && "Column and permutation must have the same length");
+    std::vector<T> out;
+    out.reserve(permutation.size());
+    for (size_t from : permutation) out.push_back(column[from]);
+    return out;
+}
+
+/*
+ * =============================================================================
+ * Parallel Sortedness and Integrity Verification
+ * =============================================================================
+ */
+
+/** What ListVerify found. When acyclic is false the other fields mean nothing. */
+struct ListVerifyResult {
+    bool acyclic = true;
+    bool sorted = true;        /* keys are non-decreasing */
+    size_t count = 0;          /* nodes in the list */
+    size_t firstUnsorted = 0;  /* position of the first node smaller than its predecessor; count if sorted */
+};
+
+/** One piece of the list, [start, end), and what walking it found. */
+struct VerifySegment {
+    const Node* start = nullptr;
+    const Node* end = nullptr;   /* the next segment's start, nullptr for the last one */
+    const Node* last = nullptr;  /* last node walked, for the seam check */
+    size_t count = 0;
+    size_t firstUnsorted = SIZE_MAX;  /* position inside the segment */
+    bool reachedEnd = true;           /* false: hit nullptr or a cycle before `end` */
+    bool cycle = false;
+};
+
+/**
+ * VerifyWalk - Walks one segment, counting nodes and looking for the first
+ * descent. Cycles are caught with Brent's method: remember a node, and move the
+ * mark forward every 1, 2, 4, 8, ... steps. A walk caught in a loop comes back
+ * to the mark within about twice the loop length, so a broken list cannot hang it.
+ */
+static void VerifyWalk(VerifySegment* seg) {
+    const Node* mark = seg->start;
+    size_t power = 1;
+    size_t steps = 0;
+    const Node* prev = nullptr;
+    for (const Node* curr = seg->start; curr != seg->end; curr = curr->next) {
+        if (curr == nullptr) {
+            seg->reachedEnd = false;
+            return;
+        }
+        if (prev != nullptr && curr->data < prev->data && seg->firstUnsorted == SIZE_MAX) {
+            seg->firstUnsorted = seg->count;
+        }
+        ++seg->count;
+        prev = curr;
+        seg->last = curr;
+
+        /* In a proper list no node points back at one we already passed. */
+        if (curr->next == mark) {
+            seg->reachedEnd = false;
+            seg->cycle = true;
+            return;
+        }
+        if (++steps == power) {
+            mark = curr;
+            power *= 2;
+            steps = 0;
+        }
+    }
+}
+
+/**
+ * ListVerify - Checks that the list is free of cycles, counts its nodes and
+ * checks that the keys never go down. For huge lists, give it `boundaries`:
+ * nodes of the list, in list order, where it may cut. Every segment is walked
+ * on its own thread, then the seams between them are checked:
+ *
+ *   head ----------> b1 ----------> b2 ----------> null
+ *   [ thread 0    ] [ thread 1    ] [ thread 2    ]
+ *                  ^               ^
+ *             seam: last of segment 0 <= b1, last of segment 1 <= b2
+ *
+ * If every segment reaches the start of the next one and the last reaches
+ * nullptr, the walk from head is exactly the segments end to end, so the list
+ * has no cycle and the counts add up. Boundaries can come from anything that
+ * already knows positions in the list: the `boundaries` output of
+ * ListParallelRadixSortBy, SkipListBoundaries, nodes remembered while building
+ * the list. If they turn out not to be in list order, ListVerify falls back to
+ * one serial walk.
+ *
+ *   std::vector<const Node*> cuts;
+ *   ListParallelRadixSort(&list, 0, &cuts);
+ *   ListVerifyResult check = ListVerify(&list, cuts);
+ *
+ * Without boundaries (or with threads = 1) it is a plain serial walk.
+ * `threads` = 0 uses every hardware thread.
+ *
+ * Time: O(n / threads + boundaries), Space: O(boundaries)
+ */
+ListVerifyResult ListVerify(const List* list, const std::vector<const Node*>& boundaries = {}, unsigned threads = 0) {
+    std::vector<VerifySegment> segments(1);
+    segments[0].start = list->head;
+    for (const Node* b : boundaries) {
+        if (b == nullptr || b == segments.back().start) continue;
+        segments.back().end = b;
+        segments.emplace_back();
+        segments.back().start = b;
+    }
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, segments.size()));
+    if (threads < 2) {
+        for (VerifySegment& seg : segments) VerifyWalk(&seg);
+    } else {
+        std::atomic<size_t> nextSegment{0};
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                for (size_t i = nextSegment++; i < segments.size(); i = nextSegment++) VerifyWalk(&segments[i]);
+            });
+        }
+        for (std::thread& w : workers) w.join();
+    }
+
+    ListVerifyResult result;
+    for (const VerifySegment& seg : segments) {
+        if (seg.cycle) {
+            result.acyclic = false;
+            result.sorted = false;
+            return result;
+        }
+    }
+    for (const VerifySegment& seg : segments) {
+        if (!seg.reachedEnd) return ListVerify(list, {}, 1);  /* boundaries out of order */
+    }
+
+    const Node* prevLast = nullptr;
+    for (const VerifySegment& seg : segments) {
+        if (seg.count == 0) continue;
+        if (result.sorted && prevLast != nullptr && seg.start->data < prevLast->data) {
+            result.sorted = false;
+            result.firstUnsorted = result.count;  /* the seam */
+        }
+        if (result.sorted && seg.firstUnsorted != SIZE_MAX) {
+            result.sorted = false;
+            result.firstUnsorted = result.count + seg.firstUnsorted;
+        }
+        result.count += seg.count;
+        prevLast = seg.last;
+    }
+    if (result.sorted) result.firstUnsorted = result.count;
+    return result;
+}
+
+/**
+ * SkipListBoundaries - `parts` - 1 nodes that cut the skip list's list into
+ * `parts` pieces of (nearly) equal length, ready for ListVerify.
+ *
+ * Time: O(parts * log n) expected
+ */
+std::vector<const Node*> SkipListBoundaries(const SkipList* sl, size_t parts) {
+    std::vector<const Node*> boundaries;
+    for (size_t i = 1; i < parts; ++i) {
+        const Node* node = SkipListNth(sl, i * sl->size / parts);
+        if (node != nullptr) boundaries.push_back(node);
+    }
+    return boundaries;
+}
+
+/*
+ * =============================================================================
+ * Execution Policy Overloads
+ * =============================================================================
+ */
+
+#if defined(__cpp_lib_execution)
+
+/*
+ * The sort, merge, verification and set-operation entry points also accept a
+ * standard execution policy as their first argument, the same way std::sort does:
+ *
+ *   ListInsertionSort(std::execution::par, &list);
+ *   ListVerify(std::execution::seq, &list);
+ *
+ * seq and unseq run on the calling thread, with the same engine as the plain
+ * call. par and par_unseq allow worker threads, and the work goes to our own
+ * std::thread code where a parallel engine exists:
+ *
+ *   entry point                        par / par_unseq runs
+ *   ListInsertionSort, ListRadixSort   ListParallelRadixSortBy (same stable order)
+ *   ListRadixSortBy                    ListParallelRadixSortBy
+ *   ListSortByCachedKey                ParallelStableSort on the key buffer
+ *   ListSortWithPermutation            ParallelStableSort on the key buffer
+ *   ListVerify                         one thread per segment between `boundaries`
+ *
+ * The policy is only a permission. ListKSortedSort (one heap that must see the
+ * nodes in order), StringListRadixSort, ListMerge and ListSetOperation (one
+ * pass that chases two pointers) run their usual serial engine under every policy.
+ *
+ * Linked lists give threads nothing to split without a walk, so parallel sorts
+ * can report where they cut the list; feed that to ListVerify to check the
+ * result in parallel too:
+ *
+ *   std::vector<const Node*> cuts;
+ *   ListRadixSort(std::execution::par, &list, &cuts);
+ *   ListVerify(std::execution::par, &list, cuts);
+ */
+
+/** Any std::execution policy type (seq, unseq, par, par_unseq). */
+template <class Policy>
+concept ExecutionPolicy = std::is_execution_policy_v<std::remove_cvref_t<Policy>>;
+
+/** True for par and par_unseq: the caller allows more than one thread. */
+template <class Policy>
+constexpr bool PolicyAllowsThreads =
+    std::is_same_v<std::remove_cvref_t<Policy>, std::execution::parallel_policy> ||
+    std::is_same_v<std::remove_cvref_t<Policy>, std::execution::parallel_unsequenced_policy>;
+
+/** The `threads` argument a policy stands for: 0 (every hardware thread) or 1. */
+template <class Policy>
+constexpr unsigned PolicyThreads = PolicyAllowsThreads<Policy> ? 0u : 1u;
+
+/**
+ * ListRadixSortBy under a policy: ListParallelRadixSortBy for par/par_unseq.
+ * `boundaries` (optional) receives the parallel sort's segment starts; it is
+ * left empty by the serial sort.
+ */
+template <ExecutionPolicy Policy, class KeyOf>
+void ListRadixSortBy(Policy&&, List* list, KeyOf keyOf, std::vector<const Node*>* boundaries = nullptr) {
+    if constexpr (PolicyAllowsThreads<Policy>) {
+        ListParallelRadixSortBy(list, keyOf, 0, boundaries);
+    } else {
+        if (boundaries != nullptr) boundaries->clear();
+        ListRadixSortBy(list, keyOf);
+    }
+}
+
+/** ListRadixSort under a policy: ListParallelRadixSort for par/par_unseq. */
+template <ExecutionPolicy Policy>
+void ListRadixSort(Policy&& policy, List* list, std::vector<const Node*>* boundaries = nullptr) {
+    ListRadixSortBy(std::forward<Policy>(policy), list, [](const Node* n) { return n->data; }, boundaries);
+}
+
+/**
+ * ListInsertionSort under a policy. seq is the insertion sort itself; par hands
+ * the list to ListParallelRadixSort, which gives the same stable order.
+ */
+template <ExecutionPolicy Policy>
+void ListInsertionSort(Policy&& policy, List* list, std::vector<const Node*>* boundaries = nullptr) {
+    if constexpr (PolicyAllowsThreads<Policy>) {
+        ListRadixSort(std::forward<Policy>(policy), list, boundaries);
+    } else {
+        if (boundaries != nullptr) boundaries->clear();
+        ListInsertionSort(list);
+    }
+}
+
+/** ListSortByCachedKey under a policy: the key buffer is sorted on every thread for par. */
+template <ExecutionPolicy Policy, class KeyOf>
+void ListSortByCachedKey(Policy&&, List* list, KeyOf keyOf) {
+    ListSortByCachedKey(list, keyOf, PolicyThreads<Policy>);
+}
+
+/** ListSortWithPermutation under a policy: the key buffer is sorted on every thread for par. */
+template <ExecutionPolicy Policy>
+std::vector<size_t> ListSortWithPermutation(Policy&&, List* list) {
+    return ListSortWithPermutation(list, PolicyThreads<Policy>);
+}
+
+/** ListKSortedSort under a policy (the same serial heap for every policy). */
+template <ExecutionPolicy Policy>
+bool ListKSortedSort(Policy&&, List* list, size_t k) {
+    return ListKSortedSort(list, k);
+}
+
+/** StringListRadixSort under a policy (the same serial MSD sort for every policy). */
+template <ExecutionPolicy Policy, class SNode>
+void StringListRadixSort(Policy&&, BasicStringList<SNode>* list) {
+    StringListRadixSort(list);
+}
+
+/**
+ * ListVerify under a policy. par checks the segments between `boundaries` on
+ * their own threads; without boundaries there is nothing to split and it is
+ * one serial walk, as under seq.
+ */
+template <ExecutionPolicy Policy>
+ListVerifyResult ListVerify(Policy&&, const List* list, const std::vector<const Node*>& boundaries = {}) {
+    return ListVerify(list, boundaries, PolicyThreads<Policy>);
+}
+
+/** ListMerge under a policy (the same single pass for every policy). */
+template <ExecutionPolicy Policy>
+void ListMerge(Policy&&, List* list, List* other) {
+    ListMerge(list, other);
+}
+
+/** ListSetOperation under a policy (the same single pass for every policy). */
+template <ExecutionPolicy Policy>
+size_t ListSetOperation(Policy&&, List* list, List* other, SetOp op, bool multiset = false,
+                        List* removed = nullptr) {
+    return ListSetOperation(list, other, op, multiset, removed);
+}
+
+#endif  /* __cpp_lib_execution */
+
+/*
+ * =============================================================================
+ * Differential Fuzz Testing
+ * =============================================================================
+ */
+
+/**
+ * Every sort engine above must give EXACTLY the order std::stable_sort gives
+ * over (key, original position). The fuzzer builds random lists, runs each
+ * engine, and compares the result node by node, by address, not by key:
+ *
+ *   input:     [5 a] -> [1 b] -> [5 c]
+ *   expected:  [1 b] -> [5 a] -> [5 c]
+ *   a result of [1 b] -> [5 c] -> [5 a] is sorted, but NOT stable: it fails.
+ *
+ * Run it with:  ./linked_list_insertion_sort --fuzz [rounds] [seed]
+ */
+
+/** The input shapes the fuzzer draws from; Count is the number of shapes. */
+enum class FuzzShape { Random, Sorted, Reversed, NearlySorted, AllEqual, FewDistinct, Sawtooth, Narrow, Extremes, Count };
+
+const char* FuzzShapeName(FuzzShape shape) {
+    switch (shape) {
+        case FuzzShape::Random: return "random";
+        case FuzzShape::Sorted: return "sorted";
+        case FuzzShape::Reversed: return "reversed";
+        case FuzzShape::NearlySorted: return "nearly-sorted";
+        case FuzzShape::AllEqual: return "all-equal";
+        case FuzzShape::FewDistinct: return "few-distinct";
+        case FuzzShape::Sawtooth: return "sawtooth";
+        case FuzzShape::Narrow: return "narrow";
+        case FuzzShape::Extremes: return "extremes";
+        default: return "?";
+    }
+}
+
+/** xorshift32, the same generator the skip list uses; seed must not be 0. */
+static uint32_t FuzzNext(uint32_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/** FuzzMakeKeys - n keys of the given shape. Small key ranges force many ties. */
+std::vector<int> FuzzMakeKeys(size_t n, FuzzShape shape, uint32_t& seed) {
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        const int r = static_cast<int>(FuzzNext(seed));
+        switch (shape) {
+            case FuzzShape::Random: keys[i] = r; break;
+            case FuzzShape::Sorted: keys[i] = static_cast<int>(i / 3); break;
+            case FuzzShape::Reversed: keys[i] = -static_cast<int>(i / 3); break;
+            case FuzzShape::NearlySorted: keys[i] = static_cast<int>(i) + (r & 15); break;
+            case FuzzShape::AllEqual: keys[i] = 42; break;
+            case FuzzShape::FewDistinct: keys[i] = (r & 3) - 1; break;
+            case FuzzShape::Sawtooth: keys[i] = static_cast<int>(i % 37); break;
+            case FuzzShape::Narrow: keys[i] = r & 0xfffff; break;  /* [0, 2^20): the top digits never vary */
+            default: {
+                static const int extremes[] = {std::numeric_limits<int>::min(), std::numeric_limits<int>::min() + 1,
+                                               -1, 0, 1, std::numeric_limits<int>::max() - 1,
+                                               std::numeric_limits<int>::max()};
+                keys[i] = extremes[static_cast<uint32_t>(r) % 7];
+                break;
+            }
+        }
+    }
+    return keys;
+}
+
+/**
+ * FuzzCheckOrder - True when the list holds exactly `expected`, node for node.
+ * The walk stops one step past the expected length, so a cycle cannot hang it.
+ */
+template <class NodeT>
+bool FuzzCheckOrder(const NodeT* head, const std::vector<const NodeT*>& expected) {
+    size_t i = 0;
+    for (const NodeT* curr = head; curr != nullptr; curr = curr->next, ++i) {
+        if (i >= expected.size() || curr != expected[i]) return false;
+    }
+    return i == expected.size();
+}
+
+/**
+ * A sort engine under test. `run` sorts the list in place; it may also fill
+ * `removed` (deduplicating engines) and may return false when a side output
+ * of its own (a permutation, a return code) is wrong.
+ */
+struct FuzzEngine {
+    const char* name;
+    size_t maxSize;  /* skip bigger inputs (O(n^2) engines) */
+    bool unique;     /* only the first node of every key is expected to survive */
+    bool (*run)(List* list, List* removed, const std::vector<Node*>& input);
+};
+
+/**
+ * FuzzBalancedBoundaries - True if a parallel sort on `threads` threads really
+ * shared the work: one boundary per extra thread, each exactly `per` nodes after
+ * the previous one, and a 4-thread ListVerify over them agrees the list is sorted.
+ */
+static bool FuzzBalancedBoundaries(const List* list, const std::vector<const Node*>& boundaries, size_t n,
+                                   size_t threads) {
+    threads = std::min(threads, n / PARALLEL_MIN_NODES_PER_THREAD);
+    if (boundaries.size() != (threads < 2 ? 0 : threads - 1)) return false;
+    const size_t per = threads < 2 ? n : (n + threads - 1) / threads;
+    size_t position = 0;
+    size_t segmentStart = 0;
+    size_t b = 0;
+    for (const Node* curr = list->head; curr != nullptr; curr = curr->next, ++position) {
+        if (b < boundaries.size() && curr == boundaries[b]) {
+            if (position - segmentStart != per) return false;
+            segmentStart = position;
+            ++b;
+        }
+    }
+    const ListVerifyResult verified = ListVerify(list, boundaries, 4);
+    return b == boundaries.size() && verified.sorted && verified.count == n;
+}
+
+/** Detaches every node of the list into a vector, in list order. */
+static std::vector<Node*> FuzzDetach(List* list) {
+    std::vector<Node*> nodes;
+    while (Node* node = ListRemoveAfter(list, nullptr)) nodes.push_back(node);
+    return nodes;
+}
+
+static const FuzzEngine FUZZ_ENGINES[] = {
+    {"ListInsertionSort", 3000, false,
+     [](List* list, List*, const std::vector<Node*>&) { ListInsertionSort(list); return true; }},
+    {"ListInsertionSortUnique", 3000, true,
+     [](List* list, List* removed, const std::vector<Node*>& input) {
+         const size_t dropped = ListInsertionSortUnique(list, removed);
+         size_t kept = 0;
+         for (const Node* curr = list->head; curr != nullptr; curr = curr->next) ++kept;
+         return kept + dropped == input.size();
+     }},
+    {"ListRadixSort", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) { ListRadixSort(list); return true; }},
+    {"ListRadixSortBy<int64_t>", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         ListRadixSortBy(list, [](const Node* n) { return static_cast<int64_t>(n->data); });
+         return true;
+     }},
+    {"ListRadixSortBy<double>", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         ListRadixSortBy(list, [](const Node* n) { return static_cast<double>(n->data); });
+         return true;
+     }},
+    {"ListParallelRadixSort", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) { ListParallelRadixSort(list, 4); return true; }},
+    {"ListParallelRadixSort(2 threads)", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         /* Few enough segments to count the next digit during the scatter (the 4-thread runs recount instead). */
+         std::vector<const Node*> boundaries;
+         ListParallelRadixSort(list, 2, &boundaries);
+         return FuzzBalancedBoundaries(list, boundaries, input.size(), 2);
+     }},
+    {"ListParallelRadixSortBy<int64_t>", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         std::vector<const Node*> boundaries;
+         ListParallelRadixSortBy(list, [](const Node* n) { return static_cast<int64_t>(n->data); }, 4, &boundaries);
+         return FuzzBalancedBoundaries(list, boundaries, input.size(), 4);
+     }},
+#if defined(__cpp_lib_execution)
+    {"ListRadixSort(par)", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) { ListRadixSort(std::execution::par, list); return true; }},
+    {"ListInsertionSort(seq)", 3000, false,
+     [](List* list, List*, const std::vector<Node*>&) { ListInsertionSort(std::execution::seq, list); return true; }},
+    {"ListInsertionSort(par)", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         std::vector<const Node*> boundaries;
+         ListInsertionSort(std::execution::par, list, &boundaries);
+         const ListVerifyResult verified = ListVerify(std::execution::par, list, boundaries);
+         return verified.sorted && verified.count == input.size();
+     }},
+    {"ListKSortedSort(seq)", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         /* A far too generous bound is still a valid one (and must not reserve 2^40 slots). */
+         return ListKSortedSort(std::execution::seq, list, size_t{1} << 40);
+     }},
+    {"ListSortByCachedKey(par)", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         ListSortByCachedKey(std::execution::par_unseq, list, [](const Node* n) { return n->data; });
+         return true;
+     }},
+    {"ListSortWithPermutation(par)", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         const std::vector<size_t> permutation = ListSortWithPermutation(std::execution::par, list);
+         return permutation.size() == input.size();
+     }},
+#endif
+    {"ListSortByColumns", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         ListSortByColumns(list, [](const Node* n) { return n->data >> 16; },
+                           [](const Node* n) { return n->data & 0xffff; });
+         return true;
+     }},
+    {"ListSortByCachedKey", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         ListSortByCachedKey(list, [](const Node* n) { return n->data; }, 4);
+         return true;
+     }},
+    {"ListSortWithPermutation", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         /* A payload column built in input order must come out in list order. */
+         const std::vector<const Node*> column(input.begin(), input.end());
+         const std::vector<size_t> permutation = ListSortWithPermutation(list, 4);
+         if (permutation.size() != column.size()) return false;
+         return FuzzCheckOrder<Node>(list->head, ApplyPermutation(column, permutation));
+     }},
+    {"ListKSortedSort", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         /* The tightest k for this input: how many places the latest node has to move up. */
+         std::vector<size_t> order(input.size());
+         std::iota(order.begin(), order.end(), size_t{0});
+         std::stable_sort(order.begin(), order.end(),
+                          [&input](size_t a, size_t b) { return input[a]->data < input[b]->data; });
+         size_t k = 0;
+         for (size_t p = 0; p < order.size(); ++p) k = std::max(k, order[p] > p ? order[p] - p : 0);
+
+         /* One short of it the bound is broken: the result must say so and keep every node. */
+         if (k > 0) {
+             if (ListKSortedSort(list, k - 1)) return false;
+             std::vector<Node*> kept = FuzzDetach(list);
+             std::vector<Node*> all = input;
+             std::sort(kept.begin(), kept.end());
+             std::sort(all.begin(), all.end());
+             if (kept != all) return false;
+             Node* tail = nullptr;
+             for (Node* node : input) ListAppend(list, tail, node);
+         }
+         return ListKSortedSort(list, k);  /* nearly-sorted inputs get k <= 15 */
+     }},
+    {"ListMerge", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>& input) {
+         /* Sort both halves on their own, then merge: the first half must win ties. */
+         std::vector<Node*> nodes = FuzzDetach(list);
+         List second;
+         Node* firstTail = nullptr;
+         Node* secondTail = nullptr;
+         for (size_t i = 0; i < nodes.size(); ++i) {
+             if (i < nodes.size() / 2) ListAppend(list, firstTail, nodes[i]);
+             else ListAppend(&second, secondTail, nodes[i]);
+         }
+         auto keyOf = [](const Node* n) { return n->data; };
+         ListSortByCachedKey(list, keyOf);
+         ListSortByCachedKey(&second, keyOf);
+         ListMerge(list, &second);
+         return second.head == nullptr && nodes.size() == input.size();
+     }},
+    {"ReorderBuffer", 3000, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         /* Push everything, then release it in a few watermark steps into one output list. */
+         ReorderBuffer rb;
+         for (Node* node : FuzzDetach(list)) {
+             if (!ReorderBufferPush(&rb, node)) return false;  /* the watermark is still INT_MIN */
+         }
+         Node* tail = nullptr;
+         for (int watermark : {-1000000, -1, 0, 1, 1000, 1000000, std::numeric_limits<int>::max()}) {
+             ReorderBufferAdvance(&rb, watermark, list, tail);
+             if (tail != ListTail(list)) return false;
+         }
+         /* Keys equal to INT_MAX never fall below a watermark; they are still pending, in order. */
+         if (rb.pending.head != nullptr) {
+             if (tail == nullptr) list->head = rb.pending.head;
+             else tail->next = rb.pending.head;
+         }
+         return true;
+     }},
+    {"PriorityQueue", SIZE_MAX, false,
+     [](List* list, List*, const std::vector<Node*>&) {
+         PriorityQueue pq;
+         for (Node* node : FuzzDetach(list)) PriorityQueuePush(&pq, node);
+         Node* tail = nullptr;
+         while (Node* node = PriorityQueuePopMin(&pq)) ListAppend(list, tail, node);
+         return PriorityQueueEmpty(&pq);
+     }},
+};
+
+/** Frees every node of a List. */
+static void FuzzFree(List* list) {
+    while (Node* node = ListRemoveAfter(list, nullptr)) delete node;
+}
+
+/**
+ * FuzzIntEngines - Runs every engine on one input. Prints the first mismatch
+ * per engine and returns how many engines failed.
+ */
+static size_t FuzzIntEngines(const std::vector<int>& keys, const char* what) {
+    size_t failures = 0;
+    for (const FuzzEngine& engine : FUZZ_ENGINES) {
+        if (keys.size() > engine.maxSize) continue;
+
+        List list;
+        Node* tail = nullptr;
+        std::vector<Node*> input;
+        for (int key : keys) {
+            input.push_back(new Node(key));
+            ListAppend(&list, tail, input.back());
+        }
+
+        /* The reference: stable_sort over (key, original position). */
+        std::vector<const Node*> expected(input.begin(), input.end());
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const Node* a, const Node* b) { return a->data < b->data; });
+        if (engine.unique) {
+            expected.erase(std::unique(expected.begin(), expected.end(),
+                                       [](const Node* a, const Node* b) { return a->data == b->data; }),
+                           expected.end());
+        }
+
+        List removed;
+        bool ok = engine.run(&list, &removed, input) && FuzzCheckOrder<Node>(list.head, expected);
+
+        /* ListVerify must agree, cutting the list into quarters. */
+        std::vector<const Node*> boundaries;
+        for (size_t q = 1; q < 4 && !expected.empty(); ++q) boundaries.push_back(expected[q * expected.size() / 4]);
+        const ListVerifyResult verified = ListVerify(&list, boundaries, 4);
+        ok = ok && verified.acyclic && verified.sorted && verified.count == expected.size();
+        if (!ok) {
+            ++failures;
+            std::cout << "FUZZ FAIL " << engine.name << ": " << what << '\n';
+        }
+        FuzzFree(&list);
+        FuzzFree(&removed);
+    }
+    return failures;
+}
+
+/**
+ * FuzzStringEngines - The same check for the string-keyed sorts. Keys share a
+ * long common prefix on some rounds, so the cached 8-byte prefixes tie and the
+ * tails have to decide.
+ */
+static size_t FuzzStringEngines(const std::vector<int>& keys, bool longPrefix, const char* what) {
+    size_t failures = 0;
+    static const char* const names[] = {"StringListInsertionSort", "StringListRadixSort", "StringListRadixSort(par)"};
+    for (int engine = 0; engine < 3; ++engine) {
+        if (engine == 0 && keys.size() > 3000) continue;
+
+        StringList list;
+        StringNode* tail = nullptr;
+        std::vector<const StringNode*> expected;
+        for (int key : keys) {
+            /* Keys of different lengths, so "7" < "70" < "8" style orders get tested. */
+            auto* node = new StringNode(std::string(longPrefix ? 12 : 0, 'x') + std::to_string(key));
+            if (tail == nullptr) list.head = node;
+            else tail->next = node;
+            tail = node;
+            expected.push_back(node);
+        }
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const StringNode* a, const StringNode* b) { return a->key < b->key; });
+
+        if (engine == 0) StringListInsertionSort(&list);
+        else if (engine == 1) StringListRadixSort(&list);
+#if defined(__cpp_lib_execution)
+        else StringListRadixSort(std::execution::par, &list);
+#else
+        else StringListRadixSort(&list);  /* no policy overloads in this build */
+#endif
+
+        if (!FuzzCheckOrder<StringNode>(list.head, expected)) {
+            ++failures;
+            std::cout << "FUZZ FAIL " << names[engine] << ": " << what << '\n';
+        }
+        StringListFree(&list);
+    }
+
+    /* StringListMerge on view nodes: odd and even keys sorted apart, then merged, against std::merge. */
+    {
+        std::vector<std::string> texts;
+        for (int key : keys) texts.push_back(std::string(longPrefix ? 12 : 0, 'x') + std::to_string(key));
+        StringViewList halves[2];
+        StringViewNode* tails[2] = {nullptr, nullptr};
+        std::vector<const StringViewNode*> sides[2];
+        for (size_t i = 0; i < texts.size(); ++i) {
+            auto* node = new StringViewNode(texts[i]);
+            if (tails[i % 2] == nullptr) halves[i % 2].head = node;
+            else tails[i % 2]->next = node;
+            tails[i % 2] = node;
+            sides[i % 2].push_back(node);
+        }
+        const auto less = [](const StringViewNode* a, const StringViewNode* b) { return a->key < b->key; };
+        std::vector<const StringViewNode*> expected;
+        for (auto& side : sides) std::stable_sort(side.begin(), side.end(), less);
+        std::merge(sides[0].begin(), sides[0].end(), sides[1].begin(), sides[1].end(), std::back_inserter(expected), less);
+
+        StringListRadixSort(&halves[0]);
+        StringListRadixSort(&halves[1]);
+        StringListMerge(&halves[0], &halves[1]);
+        if (halves[1].head != nullptr || !FuzzCheckOrder<StringViewNode>(halves[0].head, expected)) {
+            ++failures;
+            std::cout << "FUZZ FAIL StringListMerge: " << what << '\n';
+        }
+        StringListFree(&halves[0]);
+        StringListFree(&halves[1]);
+    }
+    return failures;
+}
+
+/** FuzzSortedList - A new list holding `keys`, sorted. */
+static List FuzzSortedList(const std::vector<int>& keys) {
+    List list;
+    Node* tail = nullptr;
+    for (int key : keys) ListAppend(&list, tail, new Node(key));
+    ListRadixSort(&list);
+    return list;
+}
+
+/**
+ * FuzzListAlgebra - Checks the algorithms that work ON sorted lists (grouping,
+ * joins, set operations, bulk removal, order statistics) against plain loops
+ * over std::vector. Prints every failed check and returns how many failed.
+ */
+static size_t FuzzListAlgebra(const std::vector<int>& keys, const char* what) {
+    size_t failures = 0;
+    auto check = [&](bool ok, const char* name) {
+        if (ok) return;
+        ++failures;
+        std::cout << "FUZZ FAIL " << name << ": " << what << '\n';
+    };
+    std::vector<int> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+
+    /* Group-by: one KeyRun per run of equal keys, over the key and over 2 * key. */
+    {
+        List list = FuzzSortedList(keys);
+        std::vector<KeyRun> runs;
+        std::vector<KeyRun> doubled;
+        const size_t runCount = ListAggregateRuns(&list, [&runs](const KeyRun& run) { runs.push_back(run); });
+        ListAggregateRuns(&list, [](const Node* n) { return 2LL * n->data; },
+                          [&doubled](const KeyRun& run) { doubled.push_back(run); });
+
+        bool ok = runCount == runs.size() && doubled.size() == runs.size();
+        size_t i = 0;
+        const Node* node = list.head;
+        for (size_t r = 0; ok && r < runs.size(); ++r) {
+            size_t j = i;
+            long long sum = 0;
+            while (j < sorted.size() && sorted[j] == sorted[i]) sum += sorted[j++];
+            const long long key = sorted[i];
+            ok = runs[r].key == sorted[i] && runs[r].first == node && runs[r].count == j - i &&
+                 runs[r].sum == sum && runs[r].min == key && runs[r].max == key &&
+                 doubled[r].first == node && doubled[r].sum == 2 * sum && doubled[r].min == 2 * key &&
+                 doubled[r].max == 2 * key;
+            for (; i < j; ++i) node = node->next;
+        }
+        check(ok && i == sorted.size(), "ListAggregateRuns");
+
+        /* Collapsing keeps exactly the first node of every run. */
+        List removed;
+        const size_t dropped = ListCollapseRuns(&list, &removed);
+        std::vector<const Node*> firsts;
+        for (const KeyRun& run : runs) firsts.push_back(run.first);
+        check(dropped == keys.size() - runs.size() && FuzzCheckOrder<Node>(list.head, firsts), "ListCollapseRuns");
+        FuzzFree(&list);
+        FuzzFree(&removed);
+    }
+
+    /* Bulk removal and partitioning on the unsorted input, against filtering a vector of the same nodes. */
+    {
+        List list;
+        Node* tail = nullptr;
+        std::vector<const Node*> nodes;
+        for (int key : keys) {
+            Node* node = new Node(key);
+            ListAppend(&list, tail, node);
+            nodes.push_back(node);
+        }
+        const auto byThree = [](const Node* n) { return n->data % 3 == 0; };
+        const auto odd = [](const Node* n) { return n->data % 2 != 0; };
+        const auto small = [](const Node* n) { return n->data < 1000; };
+        const auto filter = [](const std::vector<const Node*>& from, auto pred, bool want) {
+            std::vector<const Node*> out;
+            for (const Node* n : from) {
+                if (pred(n) == want) out.push_back(n);
+            }
+            return out;
+        };
+
+        /* `removed` already holds a node: the removed ones must go after it. */
+        List removed;
+        Node* removedTail = nullptr;
+        ListAppend(&removed, removedTail, new Node(-1));
+        std::vector<const Node*> expectedRemoved = filter(nodes, byThree, true);
+        expectedRemoved.insert(expectedRemoved.begin(), removed.head);
+        std::vector<const Node*> kept = filter(nodes, byThree, false);
+        bool ok = ListRemoveIf(&list, byThree, &removed) == expectedRemoved.size() - 1 &&
+                  FuzzCheckOrder<Node>(list.head, kept) && FuzzCheckOrder<Node>(removed.head, expectedRemoved);
+
+        /* Without `removed` the nodes are deleted (ASan builds catch a leak or a double free). */
+        const size_t oddCount = filter(kept, odd, true).size();
+        kept = filter(kept, odd, false);
+        ok = ok && ListRemoveIf(&list, odd) == oddCount && FuzzCheckOrder<Node>(list.head, kept);
+        check(ok, "ListRemoveIf");
+
+        List rest;
+        const std::vector<const Node*> stay = filter(kept, small, true);
+        const std::vector<const Node*> moved = filter(kept, small, false);
+        check(ListPartition(&list, small, &rest) == moved.size() && FuzzCheckOrder<Node>(list.head, stay) &&
+                  FuzzCheckOrder<Node>(rest.head, moved),
+              "ListPartition");
+        FuzzFree(&list);
+        FuzzFree(&removed);
+        FuzzFree(&rest);
+    }
+
+    /*
+     * The policy overloads of ListMerge and ListSetOperation, on the sorted keys
+     * and a second sorted list with repeated and shifted keys. ListMerge must
+     * match std::merge node for node. ListSetOperation keeps the FIRST nodes of
+     * a run where std::set_* copies the last ones, so its keys are compared with
+     * std::set_* and its nodes only have to account for every input exactly once.
+     */
+    {
+        std::vector<int> otherKeys;
+        for (size_t i = 0; i < keys.size(); i += 2) otherKeys.push_back(i % 4 == 0 ? keys[i] : keys[i] / 2);
+        std::vector<int> otherSorted = otherKeys;
+        std::sort(otherSorted.begin(), otherSorted.end());
+
+        List list = FuzzSortedList(keys);
+        List other = FuzzSortedList(otherKeys);
+        std::vector<const Node*> expected;
+        {
+            std::vector<const Node*> a;
+            std::vector<const Node*> b;
+            for (const Node* n = list.head; n != nullptr; n = n->next) a.push_back(n);
+            for (const Node* n = other.head; n != nullptr; n = n->next) b.push_back(n);
+            std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected),
+                       [](const Node* x, const Node* y) { return x->data < y->data; });
+        }
+#if defined(__cpp_lib_execution)
+        ListMerge(std::execution::par, &list, &other);
+#else
+        ListMerge(&list, &other);
+#endif
+        check(other.head == nullptr && FuzzCheckOrder<Node>(list.head, expected), "ListMerge(par)");
+        FuzzFree(&list);
+
+        static const char* const opNames[] = {"Union", "Intersection", "Difference", "SymmetricDifference"};
+        for (int mode = 0; mode < 2; ++mode) {
+            const bool multiset = mode == 1;
+            std::vector<int> a = sorted;
+            std::vector<int> b = otherSorted;
+            if (!multiset) {
+                a.erase(std::unique(a.begin(), a.end()), a.end());
+                b.erase(std::unique(b.begin(), b.end()), b.end());
+            }
+            for (int o = 0; o < 4; ++o) {
+                const SetOp op = static_cast<SetOp>(o);
+                std::vector<int> want;
+                auto out = std::back_inserter(want);
+                if (op == SetOp::Union) std::set_union(a.begin(), a.end(), b.begin(), b.end(), out);
+                else if (op == SetOp::Intersection) std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out);
+                else if (op == SetOp::Difference) std::set_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+                else std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+
+                List left = FuzzSortedList(keys);
+                List right = FuzzSortedList(otherKeys);
+                std::vector<const Node*> inputs;
+                for (const Node* n = left.head; n != nullptr; n = n->next) inputs.push_back(n);
+                for (const Node* n = right.head; n != nullptr; n = n->next) inputs.push_back(n);
+
+                List removed;
+#if defined(__cpp_lib_execution)
+                const size_t kept = ListSetOperation(std::execution::seq, &left, &right, op, multiset, &removed);
+#else
+                const size_t kept = ListSetOperation(&left, &right, op, multiset, &removed);
+#endif
+                std::vector<int> got;
+                std::vector<const Node*> seen;
+                for (const Node* n = left.head; n != nullptr && got.size() <= want.size(); n = n->next) {
+                    got.push_back(n->data);
+                    seen.push_back(n);
+                }
+                for (const Node* n = removed.head; n != nullptr && seen.size() <= inputs.size(); n = n->next) {
+                    seen.push_back(n);
+                }
+                std::sort(inputs.begin(), inputs.end());
+                std::sort(seen.begin(), seen.end());
+                if (kept != want.size() || got != want || right.head != nullptr || seen != inputs) {
+                    ++failures;
+                    std::cout << "FUZZ FAIL ListSetOperation(" << opNames[o] << (multiset ? ", multiset" : "")
+                              << "): " << what << '\n';
+                }
+                FuzzFree(&left);
+                FuzzFree(&removed);
+            }
+        }
+    }
+
+    /* Merge-join against a nested-loop join, on up to 300 keys a side (the output is a cross product). */
+    {
+        const std::vector<int> leftKeys(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(std::min<size_t>(keys.size(), 300)));
+        std::vector<int> rightKeys;
+        for (size_t i = 0; i < leftKeys.size(); ++i) rightKeys.push_back(i % 2 == 0 ? leftKeys[i] : leftKeys[i] / 2);
+        List left = FuzzSortedList(leftKeys);
+        List right = FuzzSortedList(rightKeys);
+
+        std::vector<std::pair<const Node*, const Node*>> pairs;
+        const size_t emitted = ListMergeJoin(&left, &right, [&pairs](const Node* a, const Node* b) { pairs.emplace_back(a, b); });
+        std::vector<std::pair<const Node*, const Node*>> expected;
+        for (const Node* a = left.head; a != nullptr; a = a->next) {
+            for (const Node* b = right.head; b != nullptr; b = b->next) {
+                if (a->data == b->data) expected.emplace_back(a, b);
+            }
+        }
+        std::sort(pairs.begin(), pairs.end());
+        std::sort(expected.begin(), expected.end());
+        check(emitted == expected.size() && pairs == expected, "ListMergeJoin");
+        FuzzFree(&left);
+        FuzzFree(&right);
+    }
+
+    /*
+     * Skip list: random inserts, removes and ranks against a sorted vector of the
+     * same nodes, every position through SkipListNth, then a split and more
+     * inserts into both halves (whose spans the split had to rewrite).
+     */
+    {
+        const std::vector<int> first(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(std::min<size_t>(keys.size(), 2000)));
+        uint32_t rng = static_cast<uint32_t>(first.size()) * 2654435761u + 1u;
+        List list = FuzzSortedList(first);
+        std::vector<Node*> ref;
+        for (Node* n = list.head; n != nullptr; n = n->next) ref.push_back(n);
+
+        auto matches = [](const SkipList& sl, const std::vector<Node*>& nodes) {
+            if (sl.size != nodes.size() || SkipListNth(&sl, nodes.size()) != nullptr) return false;
+            size_t i = 0;
+            for (const Node* n = sl.list->head; n != nullptr; n = n->next, ++i) {
+                if (i >= nodes.size() || n != nodes[i]) return false;
+            }
+            for (size_t k = 0; k < nodes.size(); ++k) {
+                if (SkipListNth(&sl, k) != nodes[k]) return false;
+            }
+            return i == nodes.size();
+        };
+        auto randomKey = [&rng, &first]() {
+            if (!first.empty() && FuzzNext(rng) % 2 == 0) return first[FuzzNext(rng) % first.size()];
+            return static_cast<int>(FuzzNext(rng) % 4096) - 2048;
+        };
+        auto lessKey = [](const Node* n, int v) { return n->data < v; };
+        auto insert = [&](SkipList* sl, std::vector<Node*>& nodes) {
+            Node* node = new Node(randomKey());
+            auto at = std::upper_bound(nodes.begin(), nodes.end(), node->data,
+                                       [](int v, const Node* n) { return v < n->data; });
+            nodes.insert(at, node);
+            SkipListInsert(sl, node);
+        };
+
+        SkipList sl;
+        SkipListBuild(&sl, &list);
+        bool ok = matches(sl, ref);
+        for (size_t op = 0; ok && op < 2 * first.size() + 16; ++op) {
+            const uint32_t kind = FuzzNext(rng) % 3;
+            if (kind == 0) {
+                insert(&sl, ref);
+            } else if (kind == 1) {
+                const int value = randomKey();
+                auto at = std::lower_bound(ref.begin(), ref.end(), value, lessKey);
+                Node* expected = (at != ref.end() && (*at)->data == value) ? *at : nullptr;
+                if (expected != nullptr) ref.erase(at);
+                Node* removed = SkipListRemove(&sl, value);
+                ok = removed == expected;
+                delete removed;
+            } else {
+                const int value = randomKey();
+                ok = SkipListRank(&sl, value) ==
+                     static_cast<size_t>(std::lower_bound(ref.begin(), ref.end(), value, lessKey) - ref.begin());
+            }
+            if (op % 256 == 0) ok = ok && matches(sl, ref);
+        }
+        ok = ok && matches(sl, ref);
+
+        /* SkipListBoundaries as the cut points of a parallel ListVerify. */
+        const std::vector<const Node*> cuts = SkipListBoundaries(&sl, 8);
+        for (size_t i = 0; ok && !ref.empty() && i < cuts.size(); ++i) ok = cuts[i] == ref[(i + 1) * ref.size() / 8];
+        const ListVerifyResult verified = ListVerify(&list, cuts, 4);
+        ok = ok && cuts.size() == (ref.empty() ? 0 : 7) && verified.acyclic && verified.sorted &&
+             verified.count == ref.size() && verified.firstUnsorted == ref.size();
+
+        SkipList tail;
+        List tailList;
+        const size_t cut = FuzzNext(rng) % (ref.size() + 1);
+        std::vector<Node*> tailRef(ref.begin() + static_cast<std::ptrdiff_t>(cut), ref.end());
+        ref.resize(cut);
+        SkipListSplit(&sl, cut, &tail, &tailList);
+        ok = ok && matches(sl, ref) && matches(tail, tailRef);
+        for (int i = 0; ok && i < 64; ++i) {
+            insert(&sl, ref);
+            insert(&tail, tailRef);
+        }
+        ok = ok && matches(sl, ref) && matches(tail, tailRef);
+        check(ok, "SkipList");
+
+        SkipListFree(&sl);
+        SkipListFree(&tail);
+        FuzzFree(&list);
+        FuzzFree(&tailList);
+    }
+
+    /*
+     * ListIndex against std::lower_bound / std::upper_bound over the list's own
+     * nodes, for n = 0, 1, 2, every 2^k - 1 (a full tree, where the countr_one
+     * decode unwinds a whole path of right steps) and the full input. Queries
+     * are stored keys, their neighbours and both ends of the int range.
+     */
+    {
+        std::vector<size_t> sizes = {0, 1, 2};
+        for (size_t full = 3; full <= keys.size(); full = 2 * full + 1) sizes.push_back(full);
+        sizes.push_back(keys.size());
+
+        bool ok = true;
+        for (size_t m : sizes) {
+            if (m > keys.size()) continue;
+            List list = FuzzSortedList(std::vector<int>(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(m)));
+            std::vector<Node*> nodes;
+            for (Node* n = list.head; n != nullptr; n = n->next) nodes.push_back(n);
+            const ListIndex index = ListIndexBuild(&list);
+
+            std::vector<int> queries = {std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 0};
+            for (size_t i = 0; i < nodes.size(); i += 1 + nodes.size() / 256) {
+                for (int64_t d = -1; d <= 1; ++d) {
+                    queries.push_back(static_cast<int>(std::clamp<int64_t>(nodes[i]->data + d, std::numeric_limits<int>::min(),
+                                                                           std::numeric_limits<int>::max())));
+                }
+            }
+            for (int value : queries) {
+                const auto lb = std::lower_bound(nodes.begin(), nodes.end(), value,
+                                                 [](const Node* n, int v) { return n->data < v; });
+                const auto ub = std::upper_bound(nodes.begin(), nodes.end(), value,
+                                                 [](int v, const Node* n) { return v < n->data; });
+                Node* const lower = (lb == nodes.end()) ? nullptr : *lb;
+                Node* const upper = (ub == nodes.end()) ? nullptr : *ub;
+                ok = ok && index.size() == m && ListIndexLowerBound(&index, value) == lower &&
+                     ListIndexUpperBound(&index, value) == upper &&
+                     ListIndexEqualRange(&index, value) == std::make_pair(lower, upper);
+            }
+            FuzzFree(&list);
+        }
+        check(ok, "ListIndex");
+    }
+
+    /*
+     * Batched lookups against one plain lower-bound walk per key: several lists
+     * (one of them empty), widths from 0 and 1 up to more than the batch, and
+     * keys below, inside and above the stored range.
+     */
+    {
+        uint32_t rng = static_cast<uint32_t>(keys.size()) * 69069u + 3u;
+        std::vector<List> lists(6);
+        for (size_t part = 0; part + 1 < lists.size(); ++part) {
+            std::vector<int> chunk;
+            for (size_t i = part; i < keys.size(); i += lists.size() - 1) chunk.push_back(keys[i]);
+            lists[part] = FuzzSortedList(chunk);
+        }
+        auto lowerBound = [](const List* list, int key) {
+            Node* curr = list->head;
+            while (curr != nullptr && curr->data < key) curr = curr->next;
+            return curr;
+        };
+        std::vector<int> queries = {std::numeric_limits<int>::min(), std::numeric_limits<int>::max()};
+        for (size_t i = 0; i < 200; ++i) {
+            const uint32_t r = FuzzNext(rng);
+            if (keys.empty() || r % 3 == 0) {
+                queries.push_back(static_cast<int>(r % 8192) - 4096);
+                continue;
+            }
+            /* A stored key or one of its neighbours (widened, since keys reach INT_MAX). */
+            const int64_t near = int64_t{keys[r % keys.size()]} + static_cast<int64_t>(r % 3) - 1;
+            queries.push_back(static_cast<int>(std::clamp<int64_t>(near, std::numeric_limits<int>::min(),
+                                                                   std::numeric_limits<int>::max())));
+        }
+
+        Node sentinel(0);
+        bool ok = true;
+        for (size_t width : {size_t{0}, size_t{1}, size_t{2}, size_t{7}, BATCH_DEFAULT_WIDTH, queries.size() + 5}) {
+            std::vector<ListLookup> lookups;
+            for (int key : queries) {
+                ListLookup lookup;
+                lookup.list = &lists[FuzzNext(rng) % lists.size()];
+                lookup.key = key;
+                lookup.result = &sentinel;  /* a lookup that never gets answered keeps this */
+                lookups.push_back(lookup);
+            }
+            ListLookupBatch(lookups, width);
+            for (const ListLookup& lookup : lookups) ok = ok && lookup.result == lowerBound(lookup.list, lookup.key);
+        }
+        check(ok, "ListLookupBatch");
+
+        ok = true;
+        for (const List& list : lists) {
+            const std::vector<Node*> results = ListLowerBoundBatch(&list, queries);
+            ok = ok && results.size() == queries.size();
+            for (size_t i = 0; ok && i < queries.size(); ++i) ok = results[i] == lowerBound(&list, queries[i]);
+        }
+        check(ok, "ListLowerBoundBatch");
+        for (List& list : lists) FuzzFree(&list);
+    }
+
+    /*
+     * Sliding windows against a sorted copy of a std::deque after every push:
+     * capacity 1, even and odd sizes, once over the keys and once over keys
+     * folded into four values, so the expiring key nearly always has equals.
+     */
+    {
+        const size_t pushes = std::min<size_t>(keys.size(), 3000);
+        static const double quantiles[] = {0.0, 0.25, 0.5, 0.9, 0.99, 1.0};
+        bool ok = true;
+        for (size_t capacity : {size_t{1}, size_t{2}, size_t{5}, size_t{64}, size_t{101}}) {
+            for (int folded = 0; folded < 2; ++folded) {
+                SlidingWindow window;
+                SlidingWindowInit(&window, capacity);
+                std::deque<int> ref;
+                for (size_t i = 0; ok && i < pushes; ++i) {
+                    const int key = folded ? keys[i] & 3 : keys[i];
+                    SlidingWindowPush(&window, key);
+                    ref.push_back(key);
+                    if (ref.size() > capacity) ref.pop_front();
+
+                    std::vector<int> sorted(ref.begin(), ref.end());
+                    std::sort(sorted.begin(), sorted.end());
+                    const size_t n = sorted.size();
+                    const double median = (n % 2 == 1) ? sorted[n / 2]
+                                                       : (static_cast<double>(sorted[n / 2 - 1]) + sorted[n / 2]) / 2.0;
+                    ok = window.index.size == n && SlidingWindowMedian(&window) == median;
+                    for (double p : quantiles) {
+                        const size_t k = static_cast<size_t>(p * static_cast<double>(n - 1) + 0.5);
+                        ok = ok && SlidingWindowQuantile(&window, p) == sorted[k];
+                    }
+                }
+                SlidingWindowFree(&window);
+            }
+        }
+        check(ok, "SlidingWindow");
+    }
+
+    /*
+     * Disorder metrics on the unsorted input against quadratic loops: every
+     * out-of-order pair, every drop between neighbours, and each key's stable
+     * sorted position counted as (smaller keys) + (equal keys in front of it).
+     */
+    {
+        const std::vector<int> input(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(std::min<size_t>(keys.size(), 2000)));
+        List list;
+        Node* tail = nullptr;
+        for (int key : input) ListAppend(&list, tail, new Node(key));
+
+        DisorderStats expected;
+        expected.length = input.size();
+        expected.sortedPrefix = input.size();
+        for (size_t i = 0; i < input.size(); ++i) {
+            if (i == 0 || input[i] < input[i - 1]) ++expected.runs;
+            if (i > 0 && input[i] < input[i - 1]) expected.sortedPrefix = std::min(expected.sortedPrefix, i);
+            size_t sortedPos = 0;
+            for (size_t j = 0; j < input.size(); ++j) {
+                if (j > i && input[i] > input[j]) ++expected.inversions;
+                if (input[j] < input[i] || (j < i && input[j] == input[i])) ++sortedPos;
+            }
+            expected.maxDisplacement = std::max(expected.maxDisplacement, sortedPos > i ? sortedPos - i : i - sortedPos);
+        }
+
+        const DisorderStats stats = ListDisorder(&list);
+        check(ListCountInversions(&list) == expected.inversions, "ListCountInversions");
+        check(stats.length == expected.length && stats.inversions == expected.inversions && stats.runs == expected.runs &&
+                  stats.maxDisplacement == expected.maxDisplacement && stats.sortedPrefix == expected.sortedPrefix,
+              "ListDisorder");
+        FuzzFree(&list);
+    }
+
+    /*
+     * AdaptiveSet against a std::multimap (which also keeps equal keys in
+     * insertion order): bursts of inserts push it into tree mode, scans relink
+     * it into a list, and every scan must give the same nodes in the same order.
+     */
+    {
+        uint32_t rng = static_cast<uint32_t>(keys.size()) * 40503u + 7u;
+        auto randomKey = [&rng, &keys]() {
+            if (!keys.empty() && FuzzNext(rng) % 2 == 0) return keys[FuzzNext(rng) % keys.size()];
+            return static_cast<int>(FuzzNext(rng) % 512) - 256;
+        };
+        AdaptiveSet set;
+        std::multimap<int, Node*> ref;
+        bool ok = true;
+        bool sawTree = false;
+        for (size_t op = 0; ok && op < std::min<size_t>(keys.size(), 1500) + 200; ++op) {
+            const uint32_t kind = FuzzNext(rng) % 16;
+            if (kind < 9 || op < 100) {
+                Node* node = new Node(randomKey());
+                ref.emplace(node->data, node);
+                AdaptiveSetInsert(&set, node);
+            } else if (kind < 12) {
+                const int value = randomKey();
+                auto it = ref.lower_bound(value);
+                Node* expected = (it != ref.end() && it->first == value) ? it->second : nullptr;
+                if (expected != nullptr) ref.erase(it);
+                Node* removed = AdaptiveSetRemove(&set, value);
+                ok = removed == expected;
+                delete removed;
+            } else if (kind < 15) {
+                const int value = randomKey();
+                auto it = ref.lower_bound(value);
+                ok = AdaptiveSetFind(&set, value) == ((it != ref.end() && it->first == value) ? it->second : nullptr);
+            } else {
+                std::vector<const Node*> expected;
+                for (const auto& entry : ref) expected.push_back(entry.second);
+                ok = FuzzCheckOrder<Node>(AdaptiveSetScan(&set)->head, expected) && !set.treeMode;
+            }
+            sawTree = sawTree || set.treeMode;
+            ok = ok && set.size == ref.size();
+        }
+        std::vector<const Node*> expected;
+        for (const auto& entry : ref) expected.push_back(entry.second);
+        ok = ok && sawTree && FuzzCheckOrder<Node>(AdaptiveSetScan(&set)->head, expected);
+        check(ok, "AdaptiveSet");
+        AdaptiveSetFree(&set);
+    }
+
+    return failures;
+}
+
+/**
+ * FuzzQuantileSketch - Checks p01..p999 and the ranks of a sketch of the keys,
+ * and of two half-sketches merged, against the exact ranks: each must be within
+ * QuantileSketchError(k) of n. k = 32 makes even small inputs compact many times.
+ */
+static size_t FuzzQuantileSketch(const std::vector<int>& keys, const char* what) {
+    if (keys.empty()) return 0;
+    std::vector<int> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    const double n = static_cast<double>(sorted.size());
+    static const double quantiles[] = {0.01, 0.05, 0.10, 0.25, 0.50, 0.75, 0.90, 0.95, 0.99, 0.999};
+
+    size_t failures = 0;
+    for (size_t k : {size_t{32}, size_t{200}}) {
+        List first;
+        List second;
+        Node* firstTail = nullptr;
+        Node* secondTail = nullptr;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (i < keys.size() / 2) ListAppend(&first, firstTail, new Node(keys[i]));
+            else ListAppend(&second, secondTail, new Node(keys[i]));
+        }
+        List whole = first;
+        if (firstTail != nullptr) firstTail->next = second.head;
+        else whole.head = second.head;
+
+        QuantileSketch sketches[2];
+        sketches[0] = ListQuantileSketch(&whole, k);
+        if (firstTail != nullptr) firstTail->next = nullptr;
+        sketches[1] = ListQuantileSketch(&first, k);
+        const QuantileSketch half = ListQuantileSketch(&second, k);
+        QuantileSketchMerge(&sketches[1], &half);
+
+        const double slack = QuantileSketchError(k) * n;
+        for (int s = 0; s < 2; ++s) {
+            bool ok = sketches[s].count == sorted.size();
+            for (double p : quantiles) {
+                /* The answer's exact ranks span its run of equal keys; p * n must fall near that span. */
+                const int value = QuantileSketchValueAt(&sketches[s], p);
+                const double below = static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+                const double upTo = static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+                ok = ok && p * n >= below - slack && p * n <= upTo + slack;
+                ok = ok && std::abs(QuantileSketchRank(&sketches[s], value) * n - below) <= slack;
+            }
+            if (!ok) {
+                ++failures;
+                std::cout << "FUZZ FAIL " << (s == 0 ? "ListQuantileSketch" : "QuantileSketchMerge") << "(k=" << k
+                          << "): " << what << '\n';
+            }
+        }
+        FuzzFree(&first);
+        FuzzFree(&second);
+    }
+    return failures;
+}
+
+/**
+ * FuzzSortEngines - Runs `rounds` random inputs through every engine, and the
+ * smaller ones through FuzzListAlgebra, and returns the number of failures
+ * (0 means everything agreed with its reference). Each failure line carries the
+ * round seed; rerunning with that seed and 1 round reproduces it.
+ *
+ * About one round in 16 is big enough to make the parallel radix sort really split,
+ * and every call ends with one such round on narrow keys (all below 2^20).
+ */
+size_t FuzzSortEngines(size_t rounds, uint32_t seed) {
+    size_t failures = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        const uint32_t roundSeed = seed + static_cast<uint32_t>(round) * 0x9E3779B9u;
+        uint32_t rng = roundSeed ? roundSeed : 1u;
+
+        const FuzzShape shape = static_cast<FuzzShape>(FuzzNext(rng) % static_cast<uint32_t>(FuzzShape::Count));
+        size_t n = FuzzNext(rng) % 2000;
+        if (FuzzNext(rng) % 16 == 0) n = 300000 + FuzzNext(rng) % 1000;
+        const std::vector<int> keys = FuzzMakeKeys(n, shape, rng);
+
+        const std::string what = std::string("seed=") + std::to_string(roundSeed) + " n=" + std::to_string(n) +
+                                 " shape=" + FuzzShapeName(shape);
+        failures += FuzzIntEngines(keys, what.c_str());
+        if (n <= 20000) failures += FuzzStringEngines(keys, (rng & 1u) != 0, what.c_str());
+        if (n <= 20000) failures += FuzzListAlgebra(keys, what.c_str());
+        failures += FuzzQuantileSketch(keys, what.c_str());
+    }
+    if (rounds > 0) {
+        uint32_t rng = seed ? seed : 1u;
+        const std::vector<int> keys = FuzzMakeKeys(300000, FuzzShape::Narrow, rng);
+        const std::string what = std::string("seed=") + std::to_string(seed) + " n=300000 shape=narrow (final round)";
+        failures += FuzzIntEngines(keys, what.c_str());
+        failures += FuzzQuantileSketch(keys, what.c_str());
+    }
+    return failures;
+}
+
+/*
+ * =============================================================================
+ * Test Functions
+ * =============================================================================
+ */
+
+/** Adds a new node to the end of the list. */
+void PushBack(List* list, int data) {
+    Node* n = new Node(data);
+    if (!list->head) {
+        list->head = n;
+        return;
+    }
+    Node* curr = list->head;
+    while (curr->next) curr = curr->next;
+    curr->next = n;
+}
+
+/** Prints the list to the console. */
+void PrintList(const List* list) {
+    const Node* curr = list->head;
+    while (curr) {
+        std::cout << curr->data;
+        if (curr->next) std::cout << " -> ";
+        curr = curr->next;
+    }
+    std::cout << '\n';
+}
+
+/**
+ * Main function to run the test.
+ * With --fuzz [rounds] [seed] it runs the differential fuzzer instead and
+ * exits non-zero if any engine disagreed with std::stable_sort.
+ */
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string_view(argv[1]) == "--fuzz") {
+        const size_t rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+        const uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 12345u;
+        const size_t failures = FuzzSortEngines(rounds, seed);
+        std::cout << "fuzz: " << rounds << " rounds, " << failures << " failures\n";
+        return failures == 0 ? 0 : 1;
+    }
+
     List mylist;
     PushBack(&mylist, 39);
     PushBack(&mylist, 45);